@@ -23,6 +23,7 @@
 
 
 class NexusDockManager;
+class NexusBuildOutput;
 class NexusSettings;
 class NewExchangePopup;
 class NexusWidgetFactory;
@@ -93,6 +94,8 @@ private slots:
     void on_new_node_editor_request(const QString& name);
     void on_strategy_toggle(const QString& name, bool toggle);
     void on_settings_change(NexusSettings* settings);
+    void on_build_finished(QStringList failed, bool cancelled);
+    void on_build_diagnostic_activated(QString file, int line, QString strategy_id);
 
 protected:
     virtual void closeEvent(QCloseEvent* event) override;
@@ -104,6 +107,7 @@ private:
     std::expected<bool, AgisException> restore_portfolios(rapidjson::Document const& j);
 
     AgisResult<bool> save_state();
+    void export_state();
 
     void setup_toolbar();
     void setup_help_menu();
@@ -117,6 +121,7 @@ private:
     void onViewVisibilityChanged(bool open);
     void onViewToggled(bool open);
     void onFileDoubleClicked(const QModelIndex& index);
+    QScintillaEditor* open_file_editor(QString const& file_path);
     void extract_flow_graphs();
     void applyVsStyle();
 
@@ -136,10 +141,21 @@ private:
     NexusDockManager*       DockManager;
     ads::CDockAreaWidget*   StatusDockArea;
     ads::CDockWidget*       TimelineDockWidget;
+    ads::CDockWidget*       BuildOutputWidget = nullptr;
+    NexusBuildOutput*       build_output = nullptr;
+
+    /// <summary>
+    /// Phase of the profile guided build the build output dock is running, if any
+    /// </summary>
+    std::optional<NexusPgoPhase> pgo_phase = std::nullopt;
+    NexusPgoReport          pgo_report;
+
+    bool start_compile(NexusPgoPhase phase);
 
     void __run();
     void __run_lambda();
     void __run_compile();
+    void __run_pgo_compile();
     void __run_link();
 
 public:
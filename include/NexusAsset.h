@@ -103,7 +103,11 @@ public:
     std::vector<std::string> column_names;
     std::vector<std::string> dt_index_str;
     std::span<const long long> dt_index;
-    std::vector<double> data;
+    std::span<const double> data;
+
+    // data is mapped from the exchange cache when there is one, copied from the asset otherwise
+    std::shared_ptr<NexusExchangeCache const> asset_cache;
+    std::vector<double> asset_data;
 };
 
 
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "Hydra.h"
+
+
+/// <summary>
+/// Process wide per bar bitmaps of the assets on an exchange that are streaming and have at least warmup
+/// bars of history. Bitmaps are kept per exchange and warmup and updated incrementally when the exchange
+/// steps: an asset that has enough history keeps its bit until it stops streaming, so only newly listed
+/// assets are probed, and only until they have warmed up. A time before the last one of an exchange means it
+/// was reset and starts over from an empty bitmap.
+/// </summary>
+class NexusAvailability
+{
+public:
+	using Bitmap = std::shared_ptr<const std::vector<uint64_t>>;
+
+	static NexusAvailability& instance();
+
+	/// <summary>
+	/// Bitmap of the available slots of an exchange for its current bar
+	/// </summary>
+	/// <param name="exchange">exchange the slots belong to</param>
+	/// <param name="datetime">current time of the exchange, a new time triggers the incremental update</param>
+	/// <param name="slots">streaming assets laid out by asset index, null for non streaming slots</param>
+	/// <param name="column_index">column used to probe for history, every column shares the same rows</param>
+	/// <param name="warmup">number of bars of history an asset needs</param>
+	/// <returns>one bit per slot, set if the asset can be evaluated</returns>
+	Bitmap get(
+		void const* exchange,
+		long long datetime,
+		std::vector<AssetPtr> const& slots,
+		size_t column_index,
+		int warmup
+	);
+
+	/// <summary>
+	/// Drop every bitmap, exchanges freed since can't pass their bits on to a new one at the same address
+	/// </summary>
+	void clear();
+
+	static bool test(std::vector<uint64_t> const& bits, size_t i) noexcept { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+private:
+	NexusAvailability() = default;
+
+	struct Entry
+	{
+		long long datetime = 0;
+		size_t size = 0;
+		std::vector<uint64_t> bits;
+		Bitmap bitmap;
+	};
+
+	std::shared_mutex mutex;
+	std::map<std::pair<void const*, int>, Entry> entries;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// <summary>
+/// Default number of bootstrap resamples drawn per strategy
+/// </summary>
+constexpr size_t NEXUS_BOOTSTRAP_RESAMPLES = 10000;
+
+/// <summary>
+/// Default block length used by the circular block bootstrap, preserves short term autocorrelation
+/// </summary>
+constexpr size_t NEXUS_BOOTSTRAP_BLOCK_SIZE = 20;
+
+
+/// <summary>
+/// Stateless counter based random number generator. The output depends only on the key and counter,
+/// so a draw is identical no matter which thread evaluates it or in what order.
+/// </summary>
+/// <param name="key">stream key (i.e. seed mixed with strategy index)</param>
+/// <param name="counter">position in the stream (i.e. resample and block index)</param>
+/// <returns>64 bit random value</returns>
+uint64_t nexus_counter_rng(uint64_t key, uint64_t counter) noexcept;
+
+
+/// <summary>
+/// Point estimate of a statistic with its bootstrap percentile confidence interval
+/// </summary>
+struct BootstrapInterval
+{
+	double point = 0.0;
+	double lower = 0.0;
+	double upper = 0.0;
+};
+
+
+/// <summary>
+/// Bootstrap confidence intervals for the annualized stats of a single return series
+/// </summary>
+struct BootstrapResult
+{
+	BootstrapInterval annualized_return;		///< annualized mean return in pct
+	BootstrapInterval annualized_volatility;	///< annualized volatility in pct
+	BootstrapInterval sharpe;					///< annualized sharpe ratio
+	bool valid = false;							///< false if the series was too short to resample
+};
+
+
+/// <summary>
+/// Circular block bootstrap engine. Each strategy's return series is resampled in parallel, block sums are
+/// taken from prefix sums so a resample costs O(T / block_size) instead of O(T).
+/// </summary>
+class NexusBootstrap
+{
+public:
+	NexusBootstrap(
+		size_t resamples = NEXUS_BOOTSTRAP_RESAMPLES,
+		size_t block_size = NEXUS_BOOTSTRAP_BLOCK_SIZE,
+		double confidence = 0.95,
+		uint64_t seed = 0
+	);
+
+	/// <summary>
+	/// Run the bootstrap over a set of nlv histories
+	/// </summary>
+	/// <param name="nlv_series">nlv history of each strategy</param>
+	/// <returns>confidence intervals for each strategy in the same order</returns>
+	std::vector<BootstrapResult> run(std::vector<std::span<const double>> const& nlv_series) const;
+
+private:
+	size_t resamples;
+	size_t block_size;
+	double confidence;
+	uint64_t seed;
+};
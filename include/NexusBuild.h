@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+/// <summary>
+/// Phases of a profile guided build, passed to the generated CMake project as NEXUS_PGO
+/// </summary>
+enum class NexusPgoPhase : uint8_t
+{
+	NONE,		///< regular build
+	GENERATE,	///< instrumented libraries that write their profile when they are unloaded
+	USE			///< optimized from the profile with link time optimization
+};
+
+extern const std::vector<std::string> nexus_pgo_strings;
+
+/// <summary>
+/// CMake of the profile guided build shared by both strategy project templates, defines the NEXUS_PGO cache
+/// variable and the nexus_pgo_target function that applies the phase to a library
+/// </summary>
+extern const std::string nexus_pgo_cmake;
+
+
+/// <summary>
+/// Backtest time after each phase of a profile guided build
+/// </summary>
+struct NexusPgoReport
+{
+	std::array<double, 3> backtest_ms = {};	///< indexed by NexusPgoPhase
+	size_t candles = 0;
+};
+
+
+/// <summary>
+/// Backtest times, candles per second and the speedup of the profile guided build over the regular one
+/// </summary>
+std::string nexus_pgo_summary(NexusPgoReport const& report);
+
+
+/// <summary>
+/// One cmake invocation of a strategy build
+/// </summary>
+struct NexusBuildStep
+{
+	std::vector<std::string> targets;		///< cmake targets built by the step, empty when configuring
+	std::vector<std::string> arguments;		///< arguments passed to cmake
+	fs::path log_file;						///< output file of the headless runner, empty to write to the console
+};
+
+
+/// <summary>
+/// The cmake invocations a compile consists of, produced by NexusEnv::__prepare_compile and run either
+/// headless by nexus_run_build or by the build output dock. Every step is a single cmake process run after
+/// the previous one, the targets of a build step are built in parallel by the native build tool.
+/// </summary>
+struct NexusBuildPlan
+{
+	fs::path build_folder;					///< working directory of every step
+	std::vector<NexusBuildStep> configure;	///< run before any build step
+	std::vector<NexusBuildStep> build;
+	size_t translation_units = 0;			///< sources in the build, the upper bound of the compile progress
+	bool per_strategy_libs = false;
+};
+
+
+/// <summary>
+/// Arguments of a cmake --build that runs up to jobs compilers at once and keeps building the targets that
+/// don't depend on a failed one
+/// </summary>
+/// <param name="generator">CMake generator of the build folder, decides the native keep going flag</param>
+std::vector<std::string> nexus_parallel_build_arguments(std::string const& generator, std::string const& config, size_t jobs);
+
+
+/// <summary>
+/// A compiler or linker diagnostic parsed from the build output
+/// </summary>
+struct NexusBuildDiagnostic
+{
+	std::string file;
+	int line = 0;							///< 0 for diagnostics without a location, like most linker errors
+	int column = 0;
+	bool is_error = true;
+	std::string code;						///< MSVC error code, empty for GCC and Clang
+	std::string message;
+};
+
+
+/// <summary>
+/// Shell command running a step from the build folder
+/// </summary>
+std::string nexus_build_command(NexusBuildPlan const& plan, NexusBuildStep const& step);
+
+
+/// <summary>
+/// Run a build plan with std::system
+/// </summary>
+/// <returns>targets that failed to build, every target if configuring failed</returns>
+std::vector<std::string> nexus_run_build(NexusBuildPlan const& plan);
+
+
+/// <summary>
+/// Target a line of build output reports a failure of: a Ninja FAILED line, a Make error line or an MSBuild
+/// error, which all name the object folder, project or library of the target
+/// </summary>
+/// <param name="targets">targets of the build step the line belongs to</param>
+std::optional<std::string> nexus_failed_target(std::string_view line, std::vector<std::string> const& targets);
+
+
+/// <summary>
+/// Parse an MSVC, GCC or Clang diagnostic from a line of build output
+/// </summary>
+std::optional<NexusBuildDiagnostic> nexus_parse_diagnostic(std::string_view line);
+
+
+/// <summary>
+/// Check if a line of build output marks the start of compiling a translation unit. Make and Ninja print
+/// "Building CXX object", MSBuild prints the bare file name of every source it compiles.
+/// </summary>
+bool nexus_is_compile_line(std::string_view line);
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QWidget>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QProcess>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTreeWidget>
+
+#include "NexusBuild.h"
+
+
+/// <summary>
+/// Build output dock. Runs the cmake steps of a build plan as child processes without blocking the GUI,
+/// streams their output, tracks progress by the translation units compiled and lists the diagnostics
+/// with the strategy whose code caused them.
+/// </summary>
+class NexusBuildOutput : public QWidget
+{
+	Q_OBJECT
+
+public:
+	NexusBuildOutput(QWidget* parent = nullptr);
+	~NexusBuildOutput();
+
+	/// <summary>
+	/// Set the callback mapping a source file of the build to the strategy it belongs to
+	/// </summary>
+	void set_source_strategy(std::function<std::optional<std::string>(fs::path const&)> source_strategy);
+
+	/// <summary>
+	/// Start building a plan, the previous output is cleared. Must not be called while a build is running.
+	/// </summary>
+	void start(NexusBuildPlan plan);
+
+	bool is_running() const noexcept { return this->running; }
+	NexusBuildPlan const& get_plan() const noexcept { return this->plan; }
+
+public slots:
+	void cancel();
+
+signals:
+	/// <summary>
+	/// Emitted once every step has finished or was cancelled
+	/// </summary>
+	/// <param name="failed">targets that failed to build, every target if configuring failed</param>
+	void build_finished(QStringList failed, bool cancelled);
+
+	/// <summary>
+	/// A diagnostic was double clicked
+	/// </summary>
+	void diagnostic_activated(QString file, int line, QString strategy_id);
+
+private:
+	void schedule();
+	void launch(NexusBuildStep const& step, bool configure);
+	void read_output(QProcess* process, bool flush);
+	void add_line(QString const& line);
+	void step_finished(QProcess* process, bool configure, bool success);
+	void finish();
+
+	NexusBuildPlan plan;
+	std::function<std::optional<std::string>(fs::path const&)> source_strategy;
+	std::unordered_map<QProcess*, QByteArray> pending_output;
+	size_t next_configure = 0;
+	size_t next_build = 0;
+	std::vector<std::string> step_targets;		///< targets of the running build step
+	std::set<std::string> blamed;				///< targets of the running build step its output reported failing
+	size_t compiled = 0;
+	size_t errors = 0;
+	size_t warnings = 0;
+	bool running = false;
+	bool cancelled = false;
+	QStringList failed;
+
+	QLabel* status;
+	QProgressBar* progress;
+	QPushButton* cancel_button;
+	QTreeWidget* diagnostics;
+	QPlainTextEdit* output;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+
+/// <summary>
+/// 64 bit FNV-1a hash of generated code
+/// </summary>
+uint64_t nexus_content_hash(std::string_view content) noexcept;
+
+
+/// <summary>
+/// Write a generated file only if its content differs from the file on disk. Unchanged files keep
+/// their timestamp, so the build only recompiles the translation units whose generated code changed.
+/// </summary>
+/// <param name="path">file to write, parent directories are created</param>
+/// <param name="content">generated content</param>
+/// <returns>true if the file was written</returns>
+bool nexus_write_if_changed(fs::path const& path, std::string const& content);
+
+
+/// <summary>
+/// Copy the files code was generated into over to their destination with nexus_write_if_changed.
+/// Generators that write straight to disk are pointed at a staging directory and synced from it.
+/// </summary>
+/// <param name="staging">directory the code was generated into, removed afterwards</param>
+/// <param name="target">directory the files belong in</param>
+/// <returns>number of files written</returns>
+size_t nexus_sync_generated(fs::path const& staging, fs::path const& target);
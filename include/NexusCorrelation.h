@@ -0,0 +1,39 @@
+#pragma once
+#include <span>
+#include <vector>
+
+#include <Eigen/Dense>
+
+/// <summary>
+/// Number of strategy columns per tile of the correlation product. Each tile pair is an independent
+/// GEMM small enough for both panels of returns to stay in cache.
+/// </summary>
+constexpr size_t NEXUS_CORRELATION_TILE = 64;
+
+
+/// <summary>
+/// Build a (T - 1) x N matrix of simple returns from a set of nlv histories. Series are aligned on
+/// their last value, bars where a series has no history or a nan value are treated as a zero return.
+/// </summary>
+/// <param name="nlv_series">nlv history of each strategy</param>
+/// <returns>column major returns matrix, one column per strategy</returns>
+Eigen::MatrixXd nexus_returns_matrix(std::vector<std::span<const double>> const& nlv_series);
+
+
+/// <summary>
+/// Pairwise pearson correlation of the columns of a returns matrix. The columns are standardized once,
+/// then the upper triangle of tile pairs is computed in parallel and mirrored.
+/// </summary>
+/// <param name="returns">returns matrix, one column per strategy</param>
+/// <param name="tile">number of columns per tile</param>
+/// <returns>N x N correlation matrix, rows and columns of constant series are nan</returns>
+Eigen::MatrixXd nexus_correlation_matrix(Eigen::MatrixXd const& returns, size_t tile = NEXUS_CORRELATION_TILE);
+
+
+/// <summary>
+/// Average linkage hierarchical clustering of a correlation matrix using the distance sqrt((1 - rho) / 2).
+/// Uses the nearest neighbour chain algorithm so the clustering is O(N^2) in time and memory.
+/// </summary>
+/// <param name="correlation">N x N correlation matrix</param>
+/// <returns>dendrogram leaf order, correlated strategies are placed next to each other</returns>
+std::vector<size_t> nexus_cluster_order(Eigen::MatrixXd const& correlation);
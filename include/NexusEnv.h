@@ -1,11 +1,16 @@
 #pragma once
 #include "NexusPch.h"
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <filesystem>
 #include <unordered_map>
 
 #include "QScintillaEditor.h"
 #include "NexusTree.h"
+#include "NexusLibrary.h"
+#include "NexusBuild.h"
+#include "NexusExchangeCache.h"
 
 #include "AgisPointers.h"
 #include "AgisErrors.h"
@@ -29,6 +34,30 @@ class Position;
 
 typedef std::shared_ptr<Position> SharedPositionPtr;
 
+
+/// <summary>
+/// One version of a compiled strategy library. The build output is copied to a versioned file name and that
+/// copy is loaded, so the next compile can overwrite the build output while the strategies of this version
+/// are still linked. The library is freed and its copy removed once the last strategy using it is gone.
+/// </summary>
+struct NexusStrategyLibrary
+{
+	NexusStrategyLibrary(fs::path const& source, fs::path const& loaded_path, NexusLibraryHandle handle);
+	~NexusStrategyLibrary();
+	NexusStrategyLibrary(NexusStrategyLibrary const&) = delete;
+	NexusStrategyLibrary& operator=(NexusStrategyLibrary const&) = delete;
+
+	/// <summary>
+	/// Check if the build output is still the one this version was loaded from
+	/// </summary>
+	bool is_current(fs::path const& source) const;
+
+	fs::path loaded_path;
+	NexusLibraryHandle handle;
+	fs::file_time_type write_time;
+	uintmax_t size = 0;
+};
+
 class NexusEnv
 {
 private:
@@ -58,16 +87,46 @@ private:
 	std::string agis_pyd_path = "";
 	std::string agis_lib_path = "";
 	std::string agis_include_path = "";
+#ifdef _WIN32
 	std::string agis_build_method = "\"Visual Studio 17 2022\"";
+#else
+	std::string agis_build_method = "\"Unix Makefiles\"";
+#endif
+	bool per_strategy_libs = false;
+	size_t build_jobs = 0;
 	std::string env_name;
 	fs::path env_path;
 
 
 	/// <summary>
-	/// AgisStrategy dll
+	/// Loaded version of each strategy library by library name
+	/// </summary>
+	std::unordered_map<std::string, std::shared_ptr<NexusStrategyLibrary>> strategy_libraries;
+
+	/// <summary>
+	/// Library each linked strategy was built from, keeps an old version loaded until its strategies are replaced
+	/// </summary>
+	std::unordered_map<std::string, std::shared_ptr<NexusStrategyLibrary>> strategy_owners;
+	size_t library_version = 0;
+
+	/// <summary>
+	/// Columnar cache of each loaded exchange, written in the background once the exchange is loaded
+	/// </summary>
+	NexusExchangeCacheWriter exchange_caches;
+
+	/// <summary>
+	/// Queue the cache of a loaded exchange to be written to the env's cache directory
+	/// </summary>
+	void __cache_exchange(std::string const& exchange_id);
+
+	void __write_strategy_libs_cmake(std::vector<std::pair<std::string, std::string>> const& strategy_units);
+	void __load_library(fs::path const& source, bool assume_live);
+
+	/// <summary>
+	/// Remove every linked strategy and free the libraries they were built from
 	/// </summary>
-	HINSTANCE AgisStrategyDLL;
-	bool agis_strategy_dll_loaded = false;
+	void __unload_libraries();
+	void __link_library(std::shared_ptr<NexusStrategyLibrary> const& library, bool assume_live);
 
 	std::vector<SharedOrderPtr> order_history;
 	std::vector<SharedPositionPtr> position_history;
@@ -80,6 +139,30 @@ public:
 	[[nodiscard]] AgisResult<bool> __run();
 	void __save_history();
 	void __compile();
+
+	/// <summary>
+	/// Generate the strategy code and CMake project without building it
+	/// </summary>
+	/// <param name="phase">phase of a profile guided build, NONE for a regular build</param>
+	/// <returns>the cmake invocations that build the strategies</returns>
+	NexusBuildPlan __prepare_compile(NexusPgoPhase phase = NexusPgoPhase::NONE);
+
+	/// <summary>
+	/// Clean up after the build of a plan from __prepare_compile, throws if any target failed
+	/// </summary>
+	void __finish_compile(NexusBuildPlan const& plan, std::vector<std::string> const& failed);
+
+	/// <summary>
+	/// Link the libraries built for a phase of a profile guided build and time a backtest with them. The
+	/// instrumented libraries are unloaded after their backtest, which writes the profile the next phase uses.
+	/// </summary>
+	/// <returns>backtest time in ms</returns>
+	double __run_pgo_phase(NexusPgoPhase phase);
+
+	/// <summary>
+	/// Regular, instrumented and profile guided build of the strategies, each followed by its backtest
+	/// </summary>
+	NexusPgoReport __compile_pgo();
 	void __link(bool assume_live = true);
 	void __reset();
 	void clear();
@@ -87,7 +170,16 @@ public:
 	AgisResult<bool> restore_strategies(rapidjson::Document const& j);
 	AgisResult<bool> restore_settings(rapidjson::Document const& j);
 	inline std::expected<bool, AgisException> restore_portfolios(rapidjson::Document const& j) { return this->hydra.restore_portfolios(j); }
-	inline std::expected<bool, AgisException> restore_exchanges(rapidjson::Document const& j) { return this->hydra.restore_exchanges(j); }
+	/// <summary>
+	/// Restore the exchanges of a saved env
+	/// </summary>
+	std::expected<bool, AgisException> restore_exchanges(rapidjson::Document const& j);
+
+	/// <summary>
+	/// Mapped cache of the exchange an asset belongs to
+	/// </summary>
+	/// <returns>nullptr while the cache is still being written, if it could not be or the asset is on no exchange</returns>
+	std::shared_ptr<NexusExchangeCache const> get_asset_cache(std::string const& asset_id) const;
 
 	AgisResult<bool> init_covariance_matrix(size_t lookback, size_t step) { return this->hydra.init_covariance_matrix(lookback, step); }
 
@@ -100,8 +192,20 @@ public:
 
 	//============================================================================
 	fs::path const& get_env_path() const { return this->env_path; }
+
+	/// <summary>
+	/// Strategy a source file of the build belongs to, generated or written by hand
+	/// </summary>
+	std::optional<std::string> source_strategy(fs::path const& file) const;
 	fs::path get_env_settings_path() const { return this->env_path / "env_settings.json"; }
+	fs::path get_env_snapshot_path() const { return this->env_path / "env_state.nxs"; }
 	std::expected<bool,AgisException> save_env(rapidjson::Document& j);
+
+	/// <summary>
+	/// Write the saved env snapshot out as env_settings.json, the env itself only restores from json when
+	/// it has no snapshot
+	/// </summary>
+	std::expected<bool,AgisException> export_env_json();
 	void set_env_name(std::string const & exe_path, std::string const & env_name);
 
 	//============================================================================
@@ -169,6 +273,8 @@ public:
 	std::string get_agis_pyd_path() const { return this->agis_pyd_path; }
 	std::string get_agis_dll_path() const { return this->agis_lib_path; }
 	std::string get_agis_build_method() const { return this->agis_build_method; }
+	bool get_per_strategy_libs() const { return this->per_strategy_libs; }
+	size_t get_build_jobs() const { return this->build_jobs; }
 
 	[[nodiscard]] AgisResult<bool> set_market_asset(
 		std::string const& exchange_id,
@@ -220,5 +326,3 @@ public:
 		return return_vec;
 	}
 };
-
-LPCWSTR StringToLPCWSTR(const std::string& str);
\ No newline at end of file
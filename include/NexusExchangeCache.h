@@ -0,0 +1,158 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Exchange.h"
+
+class QFile;
+
+namespace fs = std::filesystem;
+
+
+/// <summary>
+/// Key of an exchange cache, hash of the relative path, size and modification time of every source file
+/// together with the datetime format. Any change to the source data produces a different key.
+/// </summary>
+/// <param name="source">source file or directory of the exchange</param>
+/// <param name="dt_format">datetime format the source is parsed with</param>
+uint64_t nexus_exchange_source_key(fs::path const& source, std::string const& dt_format);
+
+
+/// <summary>
+/// Asset stored in an exchange cache, the spans point into the mapped file
+/// </summary>
+struct NexusMappedAsset
+{
+	std::string_view asset_id;
+	size_t rows = 0;
+	std::vector<std::string_view> columns;	///< in the order of the data columns
+	std::span<long long const> dt_index;
+	std::span<double const> data;			///< column major, rows values per column
+
+	std::span<double const> column(size_t i) const noexcept { return this->data.subspan(i * this->rows, this->rows); }
+};
+
+
+/// <summary>
+/// Memory mapped columnar copy of a loaded exchange: the merged datetime index of the exchange followed by the
+/// column major data and index of every asset, each 64 byte aligned, and a directory of the assets at the end.
+/// Opening one only reads the header and the directory, the pages of an asset fault in when it is touched.
+///
+///		header:     "NXEC" | uint32 version | uint64 key | uint64 dt count | uint64 asset count | uint64 directory offset
+///		dt index:   int64[dt count]
+///		asset data: double[rows * columns] | int64[rows]
+///		directory:  per asset string id | uint64 rows | uint64 data offset | uint64 dt offset | uint32 columns | string names
+///
+/// Strings are a uint32 length followed by the bytes, all values are little endian.
+/// </summary>
+class NexusExchangeCache
+{
+public:
+	static constexpr uint32_t version = 1;
+
+	~NexusExchangeCache();
+
+	/// <summary>
+	/// Write the assets of a loaded exchange to a cache file
+	/// </summary>
+	/// <param name="path">cache file, replaced once it is complete</param>
+	/// <param name="key">source key, see nexus_exchange_source_key</param>
+	/// <param name="exchange">exchange to cache</param>
+	static void write(fs::path const& path, uint64_t key, ExchangePtr const& exchange);
+
+	/// <summary>
+	/// Map a cache file
+	/// </summary>
+	/// <returns>nullptr if the file doesn't exist, is of another version or was written for another key</returns>
+	static std::shared_ptr<NexusExchangeCache const> open(fs::path const& path, uint64_t key);
+
+	std::span<long long const> get_dt_index() const noexcept { return this->dt_index; }
+	NexusMappedAsset const* get_asset(std::string const& asset_id) const;
+	size_t asset_count() const noexcept { return this->assets.size(); }
+
+private:
+	NexusExchangeCache() = default;
+
+	std::unique_ptr<QFile> file;
+	unsigned char* map = nullptr;
+	std::span<long long const> dt_index;
+	std::unordered_map<std::string_view, NexusMappedAsset> assets;
+};
+
+
+/// <summary>
+/// Writes the caches of loaded exchanges on a background thread so neither the restore nor an asset window
+/// waits on them. One file is written at a time, more writers would only compete for the same disk. The source
+/// data of a loaded exchange is never modified, so it is read while hydra runs on another thread.
+/// </summary>
+class NexusExchangeCacheWriter
+{
+public:
+	NexusExchangeCacheWriter() = default;
+	~NexusExchangeCacheWriter();
+
+	NexusExchangeCacheWriter(NexusExchangeCacheWriter const&) = delete;
+	NexusExchangeCacheWriter& operator=(NexusExchangeCacheWriter const&) = delete;
+
+	/// <summary>
+	/// Queue the cache of a loaded exchange, replacing the one of an exchange loaded before under the same id
+	/// </summary>
+	/// <param name="path">cache file, only written if it is missing or was written for other source files</param>
+	void schedule(std::string const& exchange_id, ExchangePtr const& exchange, fs::path const& path);
+
+	/// <summary>
+	/// Drop the cache of an exchange, a write already in progress still finishes
+	/// </summary>
+	void remove(std::string const& exchange_id);
+
+	/// <summary>
+	/// Drop every cache and the writes that have not started yet
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Mapped cache of the exchange an asset belongs to, mapped the first time it is asked for once written
+	/// </summary>
+	/// <returns>nullptr while the cache is being written, if the write failed or the asset is on no exchange</returns>
+	std::shared_ptr<NexusExchangeCache const> get(std::string const& asset_id) const;
+
+private:
+	struct Job
+	{
+		std::string exchange_id;
+		ExchangePtr exchange;
+		fs::path path;
+		size_t generation;
+	};
+
+	struct Entry
+	{
+		fs::path path;
+		size_t generation = 0;
+		bool written = false;
+		std::optional<uint64_t> key;	///< key the file was written for, nullopt if the write failed
+		std::shared_ptr<NexusExchangeCache const> cache;
+	};
+
+	void run();
+
+	mutable std::mutex mutex;
+	std::condition_variable queued;
+	std::deque<Job> queue;
+	mutable std::unordered_map<std::string, Entry> entries;
+	std::unordered_map<std::string, std::string> asset_exchanges;	///< exchange id of each cached asset id
+	size_t generation = 0;
+	bool stopping = false;
+	std::thread worker;
+};
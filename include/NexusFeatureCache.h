@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+
+/// <summary>
+/// Process wide cache of cross sectional feature buffers shared by every abstract strategy. Entries are keyed
+/// by exchange and the hash of a compiled kernel prefix, so strategies whose chains start with the same
+/// instructions compute that prefix once per bar. All entries of an exchange are dropped when it steps.
+/// Kernels subscribe their prefixes while they are live, only a prefix more than one of them starts with is
+/// worth publishing, every other one would be copied into the cache and never read.
+/// </summary>
+class NexusFeatureCache
+{
+public:
+	using Buffer = std::shared_ptr<const std::vector<double>>;
+
+	/// <summary>
+	/// Private cache, strategies share the one returned by instance()
+	/// </summary>
+	NexusFeatureCache() = default;
+
+	static NexusFeatureCache& instance();
+
+	/// <summary>
+	/// Look up the buffer of a kernel prefix for the current bar of an exchange
+	/// </summary>
+	/// <param name="exchange">exchange the prefix was evaluated on</param>
+	/// <param name="datetime">current time of the exchange, a new time invalidates the exchange's entries</param>
+	/// <param name="prefix_hash">hash of the kernel prefix</param>
+	/// <returns>cached buffer or nullptr</returns>
+	Buffer get(void const* exchange, long long datetime, size_t prefix_hash);
+
+	/// <summary>
+	/// Publish the buffer of a kernel prefix for the current bar of an exchange
+	/// </summary>
+	void put(void const* exchange, long long datetime, size_t prefix_hash, std::vector<double> const& values);
+
+	/// <summary>
+	/// Count a kernel as a reader of its prefixes, see NexusLambdaKernel::feature_keys
+	/// </summary>
+	void subscribe(std::vector<size_t> const& keys);
+	void unsubscribe(std::vector<size_t> const& keys);
+
+	/// <summary>
+	/// True if more than one live kernel subscribed to a prefix
+	/// </summary>
+	bool is_shared(size_t prefix_hash);
+
+	void clear();
+
+	size_t hits() const noexcept { return this->hit_count.load(std::memory_order_relaxed); }
+	size_t misses() const noexcept { return this->miss_count.load(std::memory_order_relaxed); }
+
+private:
+	struct ExchangeEntries
+	{
+		long long datetime = 0;
+		std::unordered_map<size_t, Buffer> buffers;
+	};
+
+	std::shared_mutex mutex;
+	std::unordered_map<void const*, ExchangeEntries> exchanges;
+	std::unordered_map<size_t, size_t> subscribers;
+	std::atomic<size_t> hit_count = 0;
+	std::atomic<size_t> miss_count = 0;
+};
+
+
+/// <summary>
+/// Subscription of the prefixes of a kernel to a feature cache for as long as it is alive
+/// </summary>
+class NexusFeatureSubscription
+{
+public:
+	NexusFeatureSubscription(NexusFeatureCache& cache, std::vector<size_t> keys);
+	~NexusFeatureSubscription();
+
+	NexusFeatureSubscription(NexusFeatureSubscription const&) = delete;
+	NexusFeatureSubscription& operator=(NexusFeatureSubscription const&) = delete;
+
+private:
+	NexusFeatureCache& cache;
+	std::vector<size_t> keys;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QJsonObject>
+
+#include "NexusNodeModel.h"
+
+namespace fs = std::filesystem;
+
+
+/// <summary>
+/// Compile a saved flow graph straight into the exchange view lambda struct of an abstract strategy.
+/// Follows the same data flow as the node models (Asset Lambda -> Exchange View -> Strategy Allocation)
+/// but works on the node json directly, so no node widgets or DataFlowGraphModel are created.
+/// </summary>
+/// <param name="flow">json object produced by DataFlowGraphModel::save</param>
+/// <param name="hydra">hydra instance used to resolve exchanges and columns</param>
+/// <returns>lambda struct or nullopt if the graph is incomplete</returns>
+std::optional<ExchangeViewLambdaStruct> nexus_compile_flow(QJsonObject const& flow, HydraPtr hydra);
+
+
+/// <summary>
+/// Compiled asset lambda kernel of a flow graph and the query of its exchange view
+/// </summary>
+struct NexusFlowKernel
+{
+	NexusLambdaKernel kernel;
+	ExchangeQueryType query_type;
+	int N;
+};
+
+
+/// <summary>
+/// Compile the asset lambda chain of a saved flow graph into a kernel without building the exchange view,
+/// used to generate the native code of the strategy. Transforms and optimizers after the view are ignored.
+/// </summary>
+/// <param name="flow">json object produced by DataFlowGraphModel::save</param>
+/// <param name="hydra">hydra instance used to resolve exchanges and columns</param>
+/// <returns>kernel or nullopt if the graph is incomplete or the chain can't be lowered</returns>
+std::optional<NexusFlowKernel> nexus_flow_kernel(QJsonObject const& flow, HydraPtr hydra);
+
+
+/// <summary>
+/// Read and parse a graph.flow file
+/// </summary>
+/// <param name="flow_path">path to the flow file</param>
+/// <returns>the flow json object, throws if the file can not be read or parsed</returns>
+QJsonObject nexus_read_flow(fs::path const& flow_path);
+
+
+/// <summary>
+/// Check if a flow graph contains nodes the generated strategy code can't express. Rolling windows and
+/// exchange view transforms only exist in Nexus, the generated code knows column[row] lookups and the
+/// engine's exchange view, so these strategies stay on the abstract path.
+/// </summary>
+bool nexus_flow_requires_abstract(QJsonObject const& flow);
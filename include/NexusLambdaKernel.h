@@ -0,0 +1,276 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Hydra.h"
+#include "NexusRollingWindow.h"
+#include "NexusSelection.h"
+
+#ifdef USE_LUAJIT
+class NexusLuaKernel;
+#endif
+struct NexusNativeKernel;
+class NexusFeatureCache;
+
+
+/// <summary>
+/// Opcodes of the flat asset lambda program. The arithmetic opcodes mirror the entries of agis_function_map,
+/// with a the running value of the chain and b the feature loaded by the instruction.
+/// </summary>
+enum class NexusLambdaOpcode : uint8_t
+{
+	INIT,		///< b
+	IDENTITY,	///< a
+	ADD,		///< a + b
+	SUBTRACT,	///< a - b
+	MULTIPLY,	///< a * b
+	DIVIDE,		///< a / b
+	FILTER		///< exclude the asset if a is outside of [lower, upper]
+};
+
+
+/// <summary>
+/// Number of assets a filter instruction has seen and how many of them it excluded
+/// </summary>
+struct NexusFilterStats
+{
+	std::atomic<size_t> evaluated = 0;
+	std::atomic<size_t> eliminated = 0;
+};
+
+
+/// <summary>
+/// Single instruction of an asset lambda program, either load column[row] (or a rolling window over the
+/// column) and apply an opcode, or filter the running value against a range
+/// </summary>
+struct NexusLambdaInstruction
+{
+	NexusLambdaOpcode opcode = NexusLambdaOpcode::INIT;
+	std::string column;			///< column name, resolved to column_index when the kernel is compiled
+	size_t column_index = 0;
+	int row = 0;
+	double lower = 0.0;
+	double upper = 0.0;
+	bool lower_inclusive = true;
+	bool upper_inclusive = true;
+	std::optional<NexusWindowType> window;			///< load a rolling window over the column instead of column[row]
+	int period = 0;
+	std::shared_ptr<NexusRollingWindow> rolling;	///< window state, created when the kernel is compiled
+	std::shared_ptr<NexusFilterStats> stats;		///< elimination counts of a filter, created when the kernel is compiled
+};
+
+
+/// <summary>
+/// Program built alongside an AgisAssetLambdaChain, nullopt if any element of the chain can not be lowered
+/// </summary>
+using NexusLambdaProgram = std::optional<std::vector<NexusLambdaInstruction>>;
+
+
+/// <summary>
+/// Build a load/apply instruction from an agis_function_map key. Returns nullopt if the operation is
+/// unknown or does not behave like the opcode it would be lowered to.
+/// </summary>
+std::optional<NexusLambdaInstruction> nexus_lambda_instruction(std::string const& op_name, std::string const& column, int row);
+
+
+/// <summary>
+/// Build a filter instruction from an asset filter range string (i.e. "[0,inf)" or "(-1.5, 1.5]")
+/// </summary>
+std::optional<NexusLambdaInstruction> nexus_filter_instruction(std::string const& filter);
+
+
+/// <summary>
+/// Format the range of a filter instruction the way asset filter ranges are written (i.e. "[0,inf)")
+/// </summary>
+std::string nexus_filter_string(NexusLambdaInstruction const& instruction);
+
+
+/// <summary>
+/// Load column[row] of an asset by column index
+/// </summary>
+/// <returns>feature value, nan if the asset is null or the feature is unavailable</returns>
+double nexus_load_feature(AssetPtr const& asset, size_t column_index, int row);
+
+
+/// <summary>
+/// Asset lambda chain lowered to a flat array of instructions with resolved column indexes. Evaluation
+/// is a single loop over the instructions with a switch on the opcode, no std::function dispatch.
+/// The chain is split into segments at each INIT, everything but the last segment only decides if the asset
+/// is excluded (nan), so segments that contain filters are hoisted to the front of the program and an
+/// asset stops loading features as soon as it has been filtered out.
+/// </summary>
+class NexusLambdaKernel
+{
+public:
+	NexusLambdaKernel() = default;
+
+	/// <summary>
+	/// Resolve the column names of a program against an exchange and hoist the segments that filter
+	/// </summary>
+	/// <param name="program">program to compile</param>
+	/// <param name="exchange">exchange the kernel will be evaluated on</param>
+	/// <returns>compiled kernel or nullopt if the program is invalid for the exchange</returns>
+	static std::optional<NexusLambdaKernel> compile(
+		std::vector<NexusLambdaInstruction> const& program,
+		ExchangePtr const exchange
+	);
+
+	/// <summary>
+	/// Evaluate the kernel on an asset
+	/// </summary>
+	/// <param name="asset">asset to evaluate</param>
+	/// <param name="count_filters">add the asset to the filter stats, off on the live path where every strategy
+	/// thread would contend on the shared counters once per asset</param>
+	/// <returns>value of the chain, nan if the asset was filtered out or a feature was unavailable</returns>
+	double evaluate(AssetPtr const& asset, bool count_filters = false) const;
+
+	/// <summary>
+	/// Evaluate the kernel across a universe of assets. Each instruction gathers its feature for every
+	/// asset into a contiguous buffer, then applies the opcode over the whole buffer in one pass.
+	/// </summary>
+	/// <param name="assets">assets to evaluate, null entries are skipped</param>
+	/// <param name="out">value of the chain for each asset, nan if filtered out or unavailable</param>
+	/// <param name="feature">scratch buffer reused between calls</param>
+	void evaluate(
+		std::vector<AssetPtr> const& assets,
+		std::vector<double>& out,
+		std::vector<double>& feature
+	) const;
+
+	/// <summary>
+	/// Apply a single instruction of the kernel across a universe of assets
+	/// </summary>
+	void evaluate_instruction(
+		size_t i,
+		std::vector<AssetPtr> const& assets,
+		std::vector<double>& out,
+		std::vector<double>& feature
+	) const;
+
+	size_t size() const noexcept { return this->program.size(); }
+	std::vector<NexusLambdaInstruction> const& instructions() const noexcept { return this->program; }
+
+	/// <summary>
+	/// Hash of the first i + 1 instructions, equal prefixes of different kernels hash the same
+	/// </summary>
+	size_t prefix_hash(size_t i) const { return this->prefix_hashes[i]; }
+
+	/// <summary>
+	/// Feature cache key of the first i + 1 instructions, the warmup is part of it as it decides which assets
+	/// the buffers hold
+	/// </summary>
+	size_t feature_key(size_t i, int warmup) const;
+
+	/// <summary>
+	/// Number of leading instructions whose prefixes can go through the feature cache. A rolling window keeps
+	/// state that only advances when the kernel owning it loads from it, so prefixes stop before the first one.
+	/// </summary>
+	size_t shared_size() const noexcept { return this->shared; }
+
+	/// <summary>
+	/// Feature cache keys of the prefixes within shared_size, see NexusFeatureCache::subscribe
+	/// </summary>
+	std::vector<size_t> feature_keys(int warmup) const;
+
+	/// <summary>
+	/// Range and elimination counts of each filter in program order
+	/// </summary>
+	std::vector<std::tuple<std::string, size_t, size_t>> filter_stats() const;
+
+private:
+	std::vector<NexusLambdaInstruction> program;
+	std::vector<size_t> prefix_hashes;
+	size_t shared = 0;
+};
+
+
+/// <summary>
+/// Per bar cross sectional values of a kernel over an exchange. Values are stored by asset index relative
+/// to the lowest index on the exchange so the exchange view can look them up in O(1).
+/// </summary>
+class NexusCrossSection
+{
+public:
+	/// <summary>
+	/// Evaluate a kernel over the assets of an exchange that are streaming and have warmup bars of history,
+	/// see NexusAvailability. The longest prefix of the kernel already computed this bar by any strategy is
+	/// taken from the NexusFeatureCache, the remaining instructions are evaluated and the prefixes another
+	/// kernel subscribed to are published back to it.
+	/// </summary>
+	/// <param name="cache">feature cache to share prefixes through, nullptr for the one of the live strategies</param>
+	void evaluate(NexusLambdaKernel const& kernel, ExchangePtr const exchange, int warmup = 0, NexusFeatureCache* cache = nullptr);
+
+#ifdef USE_LUAJIT
+	/// <summary>
+	/// Evaluate a LuaJIT kernel over the available assets of an exchange. The generated Lua loads the
+	/// features of each asset itself and stops at the first filter it fails, so it bypasses the feature cache.
+	/// </summary>
+	/// <param name="source">kernel the Lua source was generated from</param>
+	void evaluate(NexusLuaKernel& kernel, NexusLambdaKernel const& source, ExchangePtr const exchange, int warmup = 0);
+#endif
+
+	/// <summary>
+	/// Evaluate the native kernel compiled into a strategy library over the available assets of an exchange.
+	/// The generated code also applies the query, so the values need no select afterwards.
+	/// </summary>
+	/// <param name="source">kernel the native code was generated from</param>
+	void evaluate(NexusNativeKernel const& kernel, NexusLambdaKernel const& source, ExchangePtr const exchange, int warmup = 0);
+
+	/// <summary>
+	/// Value of the last evaluation for an asset, nan if it was not evaluated
+	/// </summary>
+	double lookup(AssetPtr const& asset) const;
+
+	/// <summary>
+	/// Mask the values of the last evaluation that fall outside of the query, see NexusSelection
+	/// </summary>
+	void select(ExchangeQueryType query_type, int N) { this->selection.select(this->values, query_type, N); }
+
+	std::vector<double> const& get_values() const noexcept { return this->values; }
+
+private:
+	/// <summary>
+	/// Lay the streaming assets of an exchange out by asset index
+	/// </summary>
+	void layout(ExchangePtr const exchange);
+
+	/// <summary>
+	/// Gather the available assets into a dense universe the kernel runs over
+	/// </summary>
+	void activate(NexusLambdaKernel const& kernel, ExchangePtr const exchange, int warmup);
+
+	/// <summary>
+	/// Write the dense results back to their slots, unavailable slots are nan
+	/// </summary>
+	void scatter(std::vector<double> const& dense);
+
+	std::vector<AssetPtr> assets;
+	std::vector<AssetPtr> active;
+	std::vector<size_t> active_slots;
+	std::vector<double> dense;
+	std::vector<double> values;
+	std::vector<double> feature;
+	NexusSelection selection;
+	size_t base = 0;
+};
+
+
+/// <summary>
+/// Timings of the interpreted chain against the compiled kernel over the same exchange view
+/// </summary>
+struct NexusKernelBenchmark
+{
+	size_t iterations = 0;
+	double interpreted_ms = 0.0;
+	double compiled_ms = 0.0;
+	double cross_sectional_ms = 0.0;
+	double sort_ms = 0.0;
+	double selection_ms = 0.0;
+	bool views_match = true;
+	std::vector<std::tuple<std::string, size_t, size_t>> filters;	///< range, evaluated and eliminated count of each filter
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+
+/// <summary>
+/// Handle to a loaded shared library, HMODULE on Windows and the dlopen handle elsewhere
+/// </summary>
+using NexusLibraryHandle = void*;
+
+
+/// <summary>
+/// File extension of shared libraries on this platform, ".dll" or ".so"
+/// </summary>
+extern const std::string nexus_library_extension;
+
+
+/// <summary>
+/// Load a shared library, symbols of a library loaded this way are not visible to the libraries loaded after it
+/// </summary>
+/// <param name="path">path to the library</param>
+/// <returns>handle to the library or nullptr, see nexus_library_error</returns>
+NexusLibraryHandle nexus_library_open(fs::path const& path);
+
+
+/// <summary>
+/// Look up an exported symbol of a loaded library
+/// </summary>
+/// <returns>address of the symbol or nullptr if the library doesn't export it</returns>
+void* nexus_library_symbol(NexusLibraryHandle library, char const* name);
+
+
+/// <summary>
+/// Release a handle returned by nexus_library_open
+/// </summary>
+void nexus_library_close(NexusLibraryHandle library);
+
+
+/// <summary>
+/// Description of the last failure of nexus_library_open or nexus_library_symbol on this thread
+/// </summary>
+std::string nexus_library_error();
+
+
+/// <summary>
+/// Search a folder for the dependencies of the libraries opened after this call, on top of the default search
+/// path. Only Windows resolves dependencies this way, elsewhere the call does nothing.
+/// </summary>
+/// <param name="folder">folder to search, empty to restore the default search path</param>
+void nexus_library_set_directory(fs::path const& folder);
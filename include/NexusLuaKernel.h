@@ -0,0 +1,58 @@
+#pragma once
+#ifdef USE_LUAJIT
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sol/sol.hpp>
+
+#include "NexusLambdaKernel.h"
+
+
+/// <summary>
+/// Translate a compiled lambda kernel into Lua source. The generated function loops over the universe and
+/// runs the whole program for each asset: features are loaded through an FFI pointer to nexus_load_feature,
+/// filters count into a stats buffer, and a filtered or missing value breaks out so the rest of the chain is
+/// skipped like in NexusLambdaKernel::evaluate.
+/// </summary>
+/// <param name="kernel">kernel to translate</param>
+/// <returns>Lua source returning the kernel function</returns>
+std::string nexus_lua_codegen(NexusLambdaKernel const& kernel);
+
+
+/// <summary>
+/// LuaJIT backed cross sectional kernel. A middle tier between the C++ kernel and a compiled strategy
+/// library, source is generated and jitted in milliseconds without a compiler toolchain.
+/// </summary>
+class NexusLuaKernel
+{
+public:
+	/// <summary>
+	/// Generate and load the Lua source for a kernel
+	/// </summary>
+	/// <returns>loaded kernel or nullptr if the source failed to load</returns>
+	static std::shared_ptr<NexusLuaKernel> compile(NexusLambdaKernel const& kernel);
+
+	/// <summary>
+	/// Run the jitted loop over a universe of assets and add its filter counts to the source kernel
+	/// </summary>
+	/// <param name="assets">assets to evaluate, null entries produce nan</param>
+	/// <param name="out">value of the chain for each asset</param>
+	void evaluate(std::vector<AssetPtr> const& assets, std::vector<double>& out);
+
+	std::string const& get_source() const noexcept { return this->source; }
+
+private:
+	NexusLuaKernel() = default;
+
+	std::mutex mutex;
+	sol::state lua;
+	sol::protected_function function;
+	std::string source;
+	std::vector<std::shared_ptr<NexusFilterStats>> filters;
+	std::vector<uint64_t> counts;		///< evaluated and eliminated of each filter during one evaluate
+};
+
+#endif
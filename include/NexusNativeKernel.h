@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "NexusLambdaKernel.h"
+
+
+/// <summary>
+/// Entry point of a native kernel, evaluates the chain for every asset and masks the values outside of the query
+/// </summary>
+using NexusNativeKernelFunction = void (*)(AssetPtr const* assets, size_t count, double* out);
+
+
+/// <summary>
+/// Export returning the hash of the kernel the native code was generated from, see nexus_native_hash
+/// </summary>
+using NexusNativeKernelHashFunction = uint64_t (*)();
+
+
+/// <summary>
+/// Building blocks the generated kernels are assembled from, written next to pch.h as nexus_kernel.h
+/// </summary>
+extern const std::string nexus_native_header;
+
+
+/// <summary>
+/// Check if a kernel can be generated as native code. Rolling windows keep per asset state in Nexus.
+/// </summary>
+bool nexus_native_supported(NexusLambdaKernel const& kernel);
+
+
+/// <summary>
+/// Hash of everything the generated code specializes on: the instructions with their resolved column indexes,
+/// the query type and N. A graph edited after the compile hashes differently and keeps its kernel interpreted.
+/// </summary>
+uint64_t nexus_native_hash(NexusLambdaKernel const& kernel, ExchangeQueryType query_type, int N);
+
+
+/// <summary>
+/// Name of the exported kernel function of a strategy, "_hash" is appended for the hash export
+/// </summary>
+std::string nexus_native_symbol(std::string const& strategy_id);
+
+
+/// <summary>
+/// Translate a compiled lambda kernel and its exchange view query into a C++ translation unit for the strategy
+/// library. Column indexes, rows, filter ranges, the query type and N are compile time constants, every
+/// instruction is an inlined functor and the chain is a straight line evaluated in one loop over the assets.
+/// </summary>
+/// <param name="kernel">kernel to translate, see nexus_native_supported</param>
+/// <param name="strategy_id">abstract strategy the kernel belongs to</param>
+/// <param name="query_type">exchange view query</param>
+/// <param name="N">number of assets the query selects</param>
+/// <returns>C++ source exporting nexus_native_symbol(strategy_id) and its hash</returns>
+std::string nexus_native_codegen(
+	NexusLambdaKernel const& kernel,
+	std::string const& strategy_id,
+	ExchangeQueryType query_type,
+	int N
+);
+
+
+/// <summary>
+/// Native kernel bound from a loaded strategy library
+/// </summary>
+struct NexusNativeKernel
+{
+	NexusNativeKernelFunction function = nullptr;
+	std::shared_ptr<void const> owner;		///< keeps the library loaded while the kernel is evaluated
+};
+
+
+/// <summary>
+/// Process wide table of the native kernels of the linked strategy libraries, one per abstract strategy. The
+/// exchange views look their kernel up by nexus_native_hash each bar, so a relinked library takes effect on
+/// the next bar and a kernel that no longer matches its graph is never run.
+/// </summary>
+class NexusNativeKernels
+{
+public:
+	static NexusNativeKernels& instance();
+
+	/// <summary>
+	/// Bind the native kernel of a strategy, replacing the one it had
+	/// </summary>
+	void set(std::string const& strategy_id, uint64_t hash, NexusNativeKernelFunction function, std::shared_ptr<void const> owner);
+
+	/// <summary>
+	/// Look up the native kernel generated for a kernel hash
+	/// </summary>
+	std::optional<NexusNativeKernel> get(uint64_t hash) const;
+
+	/// <summary>
+	/// Unbind every kernel of a library
+	/// </summary>
+	void release(std::shared_ptr<void const> const& owner);
+
+	void clear();
+
+private:
+	NexusNativeKernels() = default;
+
+	mutable std::shared_mutex mutex;
+	std::unordered_map<std::string, std::pair<uint64_t, NexusNativeKernel>> strategies;	///< (hash, kernel) by strategy id
+};
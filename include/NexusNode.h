@@ -34,6 +34,7 @@ using QtNodes::BasicGraphicsScene;
 namespace fs = std::filesystem;
 
 class NexusEnv;
+class NexusPreview;
 
 namespace Ui {
     class NexusNodeEditor;
@@ -63,6 +64,7 @@ public:
         std::optional<fs::path> file_path = std::nullopt
     );
     static std::optional<ExchangeViewLambdaStruct>  __extract_abstract_strategy(DataFlowGraphModel* dataFlowGraphModel);
+    void __benchmark_kernels();
 
     std::string get_strategy_id() { return this->strategy_id; }
 
@@ -71,12 +73,14 @@ private:
     void handleCheckBoxStateChange(QCheckBox* checkBox, std::function<AgisResult<bool>(bool)> setFunction);
     void create_strategy_tab(QVBoxLayout* l);
     void on_tw_change(int index);
+    void connect_preview();
 
     static size_t counter;
     size_t id;
 
     DataFlowGraphModel* dataFlowGraphModel;
     GraphicsView* view;
+    NexusPreview* preview;          ///< Exchange view of the graph evaluated in the background
 
     NexusEnv const* nexus_env;
     AgisStrategy* strategy;
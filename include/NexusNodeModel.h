@@ -7,6 +7,10 @@
 
 #include "NexusPch.h"
 #include "NexusNodeWidget.h"
+#include "NexusLambdaKernel.h"
+#include "NexusViewTransform.h"
+#include "NexusOptimizer.h"
+#include "NexusPreview.h"
 #include "AgisStrategy.h"
 
 #include "Hydra.h"
@@ -46,11 +50,13 @@ class AssetLambdaData : public NodeData
 {
 public:
     AssetLambdaData() = default;
-    AssetLambdaData(AgisAssetLambdaChain lambda_chain_, int warmup) : lambda_chain(lambda_chain_) {};
+    AssetLambdaData(AgisAssetLambdaChain lambda_chain_, int warmup, NexusLambdaProgram program_ = std::nullopt) :
+        lambda_chain(lambda_chain_), program(std::move(program_)) {};
 
     NodeDataType type() const override { return NodeDataType{ "Asset Lambda", "Asset Lambda" }; }
 
     AgisAssetLambdaChain lambda_chain;
+    NexusLambdaProgram program;     ///< the same chain lowered for NexusLambdaKernel
     int warmup = 0;
 };
 
@@ -84,6 +90,77 @@ public:
     TradeExitPtr trade_exit;
 };
 
+/**
+ * @brief Append an asset lambda operation (and optional filter) to a chain and its kernel program
+*/
+void nexus_push_asset_lambda(
+    AgisAssetLambdaChain& lambda_chain,
+    NexusLambdaProgram& program,
+    std::string const& op_str,
+    std::string const& column_name,
+    int row,
+    std::string const& filter_str
+);
+
+/**
+ * @brief Convert the string columns of a chain to column indexes of an exchange, nullopt if a column is missing
+*/
+std::optional<AgisAssetLambdaChain> nexus_resolve_lambda_chain(
+    AgisAssetLambdaChain& lambda_chain,
+    ExchangePtr const exchange
+);
+
+/**
+ * @brief Number of bars of history a chain needs before it can be evaluated
+*/
+int nexus_lambda_chain_warmup(AgisAssetLambdaChain& lambda_chain);
+
+/**
+ * @brief Build the exchange view lambda struct for a resolved chain
+*/
+ExchangeViewLambdaStruct nexus_exchange_view_struct(
+    AgisAssetLambdaChain const& lambda_chain,
+    NexusLambdaProgram const& program,
+    ExchangePtr const exchange,
+    ExchangeQueryType query_type,
+    int N,
+    int warmup,
+    bool cross_sectional,
+    bool luajit = false
+);
+
+/**
+ * @brief Wrap the exchange view lambda of a struct so a cross sectional transform is applied to every view it generates
+*/
+ExchangeViewLambdaStruct nexus_transform_view_struct(
+    ExchangeViewLambdaStruct ev_struct,
+    NexusViewTransform const& transform
+);
+
+/**
+ * @brief Wrap the exchange view lambda of a struct so the view weights are replaced by optimized portfolio weights
+ * @throws std::runtime_error if the covariance matrix of the exchanges has not been initialized
+*/
+ExchangeViewLambdaStruct nexus_optimizer_view_struct(
+    ExchangeViewLambdaStruct ev_struct,
+    NexusOptimizerSettings const& settings,
+    HydraPtr const hydra
+);
+
+/**
+ * @brief Build the strategy allocation struct from the values of a strategy allocation node
+*/
+StrategyAllocLambdaStruct nexus_strategy_alloc_struct(
+    std::string const& epsilon,
+    std::string const& target_leverage,
+    bool clear_missing,
+    std::string const& alloc_type,
+    std::string const& ev_opp_type,
+    std::optional<std::string> const& ev_opp_param,
+    std::optional<TradeExitPtr> const& trade_exit
+);
+
+
 /**
  * @brief Node data model for an asset lambda function
 */
@@ -161,6 +238,83 @@ private:
 
     AssetLambdaNode* asset_lambda_node = nullptr;
     AgisAssetLambdaChain lambda_chain;
+    NexusLambdaProgram program = std::vector<NexusLambdaInstruction>{};
+    int warmup = -1;
+
+};
+
+
+/**
+ * @brief Node data model for a rolling window over a column (SMA, EMA, STD, ...). Appends to the same
+ * asset lambda chain as AssetLambdaModel, the window is stored in the element's column (see nexus_window_column)
+*/
+class AssetWindowModel : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    AssetWindowModel() = default;
+    virtual ~AssetWindowModel() {}
+
+public:
+    QString caption() const override { return QString("Asset Window"); }
+
+    QString name() const override { return QString("Asset Window"); }
+
+    QWidget* embeddedWidget() override;
+
+public:
+    unsigned int nPorts(PortType const portType) const override
+    {
+        unsigned int result = 1;
+
+        switch (portType) {
+        case PortType::In:
+            result = 1;
+            break;
+
+        case PortType::Out:
+            result = 1;
+            break;
+        case PortType::None:
+            break;
+        }
+
+        return result;
+    }
+
+    NodeDataType dataType(PortType const portType, PortIndex const portIndex) const override
+    {
+        switch (portType) {
+        case PortType::Out:
+        case PortType::In:
+            switch (portIndex)
+            {
+            case 0:
+                return AssetLambdaData().type();
+            }
+            break;
+
+        case PortType::None:
+            break;
+        }
+        return NodeDataType();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const port) override;
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const port) override;
+
+    QJsonObject save() const override;
+    void load(QJsonObject const &p) override;
+
+    void on_filter_change();
+    void on_lambda_change();
+
+private:
+
+    AssetWindowNode* asset_window_node = nullptr;
+    AgisAssetLambdaChain lambda_chain;
+    NexusLambdaProgram program = std::vector<NexusLambdaInstruction>{};
     int warmup = -1;
 
 };
@@ -310,10 +464,25 @@ public:
 
     void on_exchange_view_change();
 
+    /// <summary>
+    /// Time the interpreted asset lambda chain against the compiled kernel by generating the same
+    /// exchange view with both
+    /// </summary>
+    /// <param name="iterations">number of exchange views to generate with each</param>
+    /// <returns>timings, nullopt if the view is not connected or the chain could not be compiled</returns>
+    std::optional<NexusKernelBenchmark> benchmark_kernel(size_t iterations) const;
+
+    /// <summary>
+    /// Copy what the preview pane needs to evaluate this view on a worker thread
+    /// </summary>
+    /// <returns>request, nullopt if the view is not connected or the chain could not be compiled</returns>
+    std::optional<NexusPreviewRequest> preview_request() const;
+
 
 private:
     ExchangePtr exchange = nullptr;
     AgisAssetLambdaChain lambda_chain;
+    NexusLambdaProgram program;
     ExchangeViewNode* exchange_view_node = nullptr;
     int warmup = 0;
 };
@@ -389,6 +558,142 @@ private:
 };
 
 
+/// Cross sectional transform of an exchange view (rank, z-score, demean, winsorize)
+class ExchangeViewTransformModel : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    ExchangeViewTransformModel() = default;
+    virtual ~ExchangeViewTransformModel() { delete this->transform_node; }
+
+public:
+    QString caption() const override { return QString("Exchange View Transform"); }
+
+    QString name() const override { return QString("Exchange View Transform"); }
+
+    QWidget* embeddedWidget() override;
+
+public:
+    unsigned int nPorts(PortType const portType) const override
+    {
+        unsigned int result = 1;
+
+        switch (portType) {
+        case PortType::In:
+            result = 1;
+            break;
+
+        case PortType::Out:
+            result = 1;
+            break;
+        case PortType::None:
+            break;
+        }
+
+        return result;
+    }
+
+    NodeDataType dataType(PortType const portType, PortIndex const portIndex) const override
+    {
+        switch (portType) {
+        case PortType::Out:
+        case PortType::In:
+            switch (portIndex) {
+            case 0:
+                return ExchangeViewData().type();
+            }
+            break;
+
+        case PortType::None:
+            break;
+        }
+        return NodeDataType();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const port) override;
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const port) override;
+
+    void on_transform_change();
+
+    QJsonObject save() const override;
+    void load(QJsonObject const& p) override;
+
+private:
+    ExchangeViewTransformNode* transform_node = nullptr;
+    std::optional<ExchangeViewLambdaStruct> ev_lambda_struct = std::nullopt;
+};
+
+
+/// Portfolio optimization of an exchange view (mean-variance, minimum variance, risk parity)
+class PortfolioOptimizerModel : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    PortfolioOptimizerModel() = default;
+    virtual ~PortfolioOptimizerModel() { delete this->optimizer_node; }
+
+public:
+    QString caption() const override { return QString("Portfolio Optimizer"); }
+
+    QString name() const override { return QString("Portfolio Optimizer"); }
+
+    QWidget* embeddedWidget() override;
+
+public:
+    unsigned int nPorts(PortType const portType) const override
+    {
+        unsigned int result = 1;
+
+        switch (portType) {
+        case PortType::In:
+            result = 1;
+            break;
+
+        case PortType::Out:
+            result = 1;
+            break;
+        case PortType::None:
+            break;
+        }
+
+        return result;
+    }
+
+    NodeDataType dataType(PortType const portType, PortIndex const portIndex) const override
+    {
+        switch (portType) {
+        case PortType::Out:
+        case PortType::In:
+            switch (portIndex) {
+            case 0:
+                return ExchangeViewData().type();
+            }
+            break;
+
+        case PortType::None:
+            break;
+        }
+        return NodeDataType();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const port) override;
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const port) override;
+
+    void on_optimizer_change();
+
+    QJsonObject save() const override;
+    void load(QJsonObject const& p) override;
+
+private:
+    PortfolioOptimizerNode* optimizer_node = nullptr;
+    std::optional<ExchangeViewLambdaStruct> ev_lambda_struct = std::nullopt;
+};
+
+
 /// Strategy Allocation Model
 class StrategyAllocationModel : public NodeDelegateModel
 {
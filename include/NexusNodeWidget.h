@@ -1,11 +1,13 @@
 #pragma once
 #include "NexusPch.h"
+#include "NexusOptimizer.h"
 #include <QPushButton>
 #include <QWidget>
 #include <QComboBox>
 #include <QLabel>
 #include <QLineEdit>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QCheckBox>
 #include <QDoubleValidator>
 
@@ -54,6 +56,23 @@ public:
     QLineEdit* filter;
 };
 
+class AssetWindowNode : public QWidget
+{
+    Q_OBJECT
+public:
+    AssetWindowNode(
+        QWidget* parent = nullptr);
+
+    ~AssetWindowNode() { delete layout; };
+
+    QVBoxLayout* layout;
+    QComboBox* window_type;
+    QSpinBox* period;
+    QComboBox* opperation;
+    QLineEdit* column;
+    QLineEdit* filter;
+};
+
 class ExchangeViewNode : public QWidget
 {
     Q_OBJECT
@@ -66,6 +85,8 @@ public:
     QVBoxLayout* layout;
     QComboBox* query_type;
     QSpinBox* N;
+    QCheckBox* cross_sectional;
+    QCheckBox* luajit;
 };
 
 class TradeExitNode : public QWidget
@@ -82,6 +103,39 @@ public:
     QLineEdit* extra_param;
 };
 
+class ExchangeViewTransformNode : public QWidget
+{
+    Q_OBJECT
+public:
+    ExchangeViewTransformNode(
+        QWidget* parent = nullptr);
+
+    ~ExchangeViewTransformNode() { delete layout; };
+
+    QVBoxLayout* layout;
+    QComboBox* transform_type;
+    QDoubleSpinBox* param;
+};
+
+class PortfolioOptimizerNode : public QWidget
+{
+    Q_OBJECT
+public:
+    PortfolioOptimizerNode(
+        QWidget* parent = nullptr);
+
+    ~PortfolioOptimizerNode() { delete layout; };
+
+    NexusOptimizerSettings settings() const;
+
+    QVBoxLayout* layout;
+    QComboBox* objective;
+    QDoubleSpinBox* risk_aversion;
+    QDoubleSpinBox* max_weight;
+    QCheckBox* long_only;
+    QLabel* status;
+};
+
 class StrategyAllocationNode : public QWidget
 {
     Q_OBJECT
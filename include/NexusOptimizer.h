@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Exchange.h"
+
+
+/// <summary>
+/// Objectives of the portfolio optimizer node
+/// </summary>
+enum class NexusOptimizerType : uint8_t
+{
+	MEAN_VARIANCE,	///< max w'mu - risk_aversion / 2 * w'Sw with the view values as mu
+	MIN_VARIANCE,	///< min w'Sw, the view only selects the universe
+	RISK_PARITY		///< equal risk contribution w_i * (Sw)_i, long only
+};
+
+extern const std::vector<std::string> nexus_optimizer_strings;
+
+
+/// <summary>
+/// Parse an objective name from nexus_optimizer_strings
+/// </summary>
+std::optional<NexusOptimizerType> nexus_optimizer_type(std::string const& name);
+
+
+struct NexusOptimizerSettings
+{
+	NexusOptimizerType type = NexusOptimizerType::MIN_VARIANCE;
+	double risk_aversion = 1.0;		///< only used by MEAN_VARIANCE
+	double max_weight = 1.0;		///< bound on |w_i|, raised to 1 / N if the budget can't be met otherwise
+	bool long_only = true;			///< w_i >= 0, RISK_PARITY is always long only
+};
+
+
+/// <summary>
+/// Replaces the values of an exchange view with fully invested (sum w = 1) optimal weights under the
+/// exchange covariance matrix. The box constrained QPs are solved with ADMM: the x update is a solve
+/// against the Cholesky factor of S + rho I, which is kept until the covariance of the selected assets
+/// changes (every cov_step bars) or the universe changes, and the iterates start from the previous bar's
+/// solution so an unchanged problem converges in a handful of O(N^2) iterations. Risk parity is solved by
+/// damped Newton on the log barrier formulation, also warm started.
+/// </summary>
+class NexusPortfolioOptimizer
+{
+public:
+	NexusPortfolioOptimizer(NexusOptimizerSettings const& settings) : settings(settings) {}
+
+	/// <summary>
+	/// Optimize the weights of a view in place. Assets whose covariance row is not available are dropped,
+	/// as are assets the solution gives a weight of exactly zero.
+	/// </summary>
+	/// <param name="view">exchange view, values are the expected returns for MEAN_VARIANCE</param>
+	/// <param name="covariance">covariance matrix indexed by asset index</param>
+	void apply(ExchangeView& view, Eigen::MatrixXd const& covariance);
+
+	/// <summary>
+	/// Solve for the weights of a universe
+	/// </summary>
+	/// <param name="indices">asset index of each weight, used to carry the solution to the next bar</param>
+	/// <param name="sigma">covariance of the universe</param>
+	/// <param name="mu">expected returns, ignored unless MEAN_VARIANCE</param>
+	/// <returns>weights summing to 1</returns>
+	Eigen::VectorXd solve(
+		std::vector<size_t> const& indices,
+		Eigen::MatrixXd const& sigma,
+		Eigen::VectorXd const& mu
+	);
+
+	NexusOptimizerSettings const& get_settings() const noexcept { return this->settings; }
+	size_t get_iterations() const noexcept { return this->iterations; }
+	size_t get_factorizations() const noexcept { return this->factorizations; }
+
+private:
+	Eigen::VectorXd solve_qp(Eigen::MatrixXd const& sigma, Eigen::VectorXd const& mu);
+	Eigen::VectorXd solve_risk_parity(Eigen::MatrixXd const& sigma);
+	void project(Eigen::VectorXd& v, double lower, double upper) const;
+	double scale() const;
+	void factorize(Eigen::MatrixXd const& sigma, double rho);
+
+	NexusOptimizerSettings settings;
+	std::mutex mutex;
+
+	// factorization of S + rho I for the universe it was built for
+	std::vector<size_t> factor_indices;
+	Eigen::MatrixXd factor_sigma;
+	Eigen::LLT<Eigen::MatrixXd> factor;
+	double rho = 1.0;
+
+	// previous solution (and scaled dual for the QPs) by asset index
+	std::unordered_map<size_t, std::pair<double, double>> warm;
+	Eigen::VectorXd z, u;
+
+	size_t iterations = 0;		///< iterations of the last solve
+	size_t factorizations = 0;	///< total Cholesky factorizations
+};
@@ -150,6 +150,8 @@ public:
     QString get_agis_lib_path() const;
     QString get_agis_pyd_path() const;
     QString get_vs_version() const;
+    bool get_per_strategy_libs() const;
+    size_t get_build_jobs() const;
 
 private slots:
     void select_folder(std::string dest);
@@ -5,9 +5,11 @@
 #include <qtreeview.h>
 #include <QStandardItemModel>
 #include <qaction.h>
+#include <QDockWidget>
 
 #include "DockWidget.h"
 
+#include "NexusCorrelation.h"
 #include "NexusEnv.h"
 #include "NexusPlot.h"
 #include "Hydra.h"
@@ -61,6 +63,28 @@ private:
 };
 
 
+/// <summary>
+/// Heatmap of the pairwise return correlation of the strategies in a portfolio, rows and columns
+/// are ordered by hierarchical clustering so redundant strategies form blocks on the diagonal.
+/// </summary>
+class NexusCorrelationPlot : public QCustomPlot
+{
+public:
+    explicit NexusCorrelationPlot(QWidget* parent_ = nullptr);
+    ~NexusCorrelationPlot() = default;
+
+    void load(
+        std::vector<std::string> const& ids,
+        Eigen::MatrixXd const& correlation,
+        std::vector<size_t> const& order
+    );
+
+private:
+    QCPColorMap* color_map;
+    QCPColorScale* color_scale;
+};
+
+
 class NexusPortfolio : public QMainWindow
 {
     Q_OBJECT
@@ -81,6 +105,9 @@ public:
 
     NexusPortfolioPlot* nexus_plot;
 
+    QDockWidget* correlation_dock;
+    NexusCorrelationPlot* correlation_plot;
+
     std::vector<std::string> get_plotted_graphs() const { return this->nexus_plot->plotted_graphs; }
     std::string get_portfolio_id() { return this->portfolio_id; }
     std::vector<std::string> get_selected_strategies() const;
@@ -88,6 +115,7 @@ public:
 public slots:
     void on_new_hydra_run();
     void on_portfolio_download();
+    void on_correlation_update();
 
 private:
     std::unordered_map<std::string, QAction*> strategies_checkboxes;
@@ -95,6 +123,12 @@ private:
     void set_up_strategies_menu();
     void set_up_portfolio_table();
     void set_up_toolbar();
+    void set_up_correlation_dock();
     NexusEnv const* nexus_env;
     std::string portfolio_id;
+
+    /// <summary>
+    /// Bumped by every run, the bootstrap intervals of an older run are dropped when they arrive
+    /// </summary>
+    uint64_t bootstrap_generation = 0;
 };
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <QFuture>
+#include <QWidget>
+#include <QLabel>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTimer>
+
+#include "NexusLambdaKernel.h"
+
+
+/// <summary>
+/// Everything needed to evaluate an exchange view node off the GUI thread, copied out of the graph
+/// </summary>
+struct NexusPreviewRequest
+{
+	ExchangePtr exchange = nullptr;
+	std::vector<NexusLambdaInstruction> program;
+	ExchangeQueryType query_type = ExchangeQueryType::Default;
+	int N = -1;
+};
+
+
+/// <summary>
+/// Values of an exchange view node at one bar
+/// </summary>
+struct NexusPreviewResult
+{
+	uint64_t generation = 0;
+	bool cancelled = false;
+	std::string error;
+	std::vector<std::string> asset_ids;
+	std::vector<double> values;
+	std::vector<bool> selected;		///< asset would be in the exchange view after the top N selection
+	double elapsed_ms = 0.0;
+};
+
+
+/// <summary>
+/// Evaluate a preview request over the streaming assets of its exchange
+/// </summary>
+/// <param name="request">exchange view to evaluate</param>
+/// <param name="row">bar to evaluate at relative to the current bar of the exchange, 0 or negative</param>
+/// <param name="cancelled">polled between instructions, evaluation stops early once it returns true</param>
+NexusPreviewResult nexus_preview_evaluate(
+	NexusPreviewRequest const& request,
+	int row,
+	std::function<bool()> const& cancelled
+);
+
+
+/// <summary>
+/// Live preview of the exchange view of a node graph. Graph edits restart a short debounce timer, once it
+/// fires the view is evaluated on a worker thread and the table is filled when it returns. Every evaluation
+/// bumps a generation counter so older evaluations still running stop early and their results are dropped.
+/// </summary>
+class NexusPreview : public QWidget
+{
+	Q_OBJECT
+
+public:
+	NexusPreview(QWidget* parent = nullptr);
+	~NexusPreview();
+
+	/// <summary>
+	/// Set the callback that copies the current exchange view out of the graph, called on the GUI thread
+	/// </summary>
+	void set_request_source(std::function<std::optional<NexusPreviewRequest>()> source);
+
+	/// <summary>
+	/// Restart the debounce timer, the preview is evaluated once the graph has been idle for the interval
+	/// </summary>
+	void schedule();
+
+private:
+	friend class NexusPreviewSuspend;
+
+	void evaluate();
+	void display(NexusPreviewResult const& result);
+
+	static std::vector<NexusPreview*> instances;	///< live previews, only touched on the GUI thread
+	static int suspended;							///< open NexusPreviewSuspend scopes
+
+	std::function<std::optional<NexusPreviewRequest>()> request_source;
+	std::shared_ptr<std::atomic<uint64_t>> generation;
+	QFuture<NexusPreviewResult> running;
+
+	QTimer* debounce;
+	QSpinBox* row;
+	QLabel* status;
+	QTableWidget* table;
+};
+
+
+/// <summary>
+/// Keeps every preview off hydra while a run advances it. Opening the scope cancels the evaluations still
+/// running and waits for them to stop, every preview is evaluated again once the last scope closes.
+/// </summary>
+class NexusPreviewSuspend
+{
+public:
+	NexusPreviewSuspend();
+	~NexusPreviewSuspend();
+
+	NexusPreviewSuspend(NexusPreviewSuspend const&) = delete;
+	NexusPreviewSuspend& operator=(NexusPreviewSuspend const&) = delete;
+};
@@ -0,0 +1,167 @@
+#pragma once
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// <summary>
+/// Number of bars per year used to annualize rolling statistics
+/// </summary>
+constexpr double NEXUS_ANNUALIZATION_FACTOR = 252.0;
+
+
+/// <summary>
+/// Fixed capacity ring buffer of doubles. Pushing into a full buffer evicts and returns
+/// the oldest value so that the rolling statistics below can update in O(1).
+/// </summary>
+class RollingBuffer
+{
+public:
+	explicit RollingBuffer(size_t capacity);
+
+	/// <summary>
+	/// Push a new value into the buffer
+	/// </summary>
+	/// <param name="value">value to push</param>
+	/// <returns>the value evicted from the buffer if it was full</returns>
+	std::optional<double> push(double value);
+
+	void clear();
+	bool full() const noexcept { return this->count == this->data.size(); }
+	size_t size() const noexcept { return this->count; }
+	size_t capacity() const noexcept { return this->data.size(); }
+
+	/// <summary>
+	/// Total number of values ever pushed, used as a monotonic sequence id
+	/// </summary>
+	size_t pushed() const noexcept { return this->sequence; }
+
+	/// <summary>
+	/// Access the i'th oldest value in the buffer
+	/// </summary>
+	double operator[](size_t i) const { return this->data[(this->head + i) % this->data.size()]; }
+
+private:
+	std::vector<double> data;
+	size_t head = 0;
+	size_t count = 0;
+	size_t sequence = 0;
+};
+
+
+/// <summary>
+/// Rolling mean and variance over a fixed window using Welford's update with removal
+/// </summary>
+class RollingVariance
+{
+public:
+	explicit RollingVariance(size_t window) : buffer(window) {}
+
+	/// <summary>
+	/// Push a new value, nan is skipped as it would poison the running moments for good
+	/// </summary>
+	void push(double value);
+	void clear();
+
+	bool ready() const noexcept { return this->buffer.full(); }
+	size_t size() const noexcept { return this->n; }
+	double mean() const noexcept { return this->n ? this->m : NAN; }
+	double variance() const noexcept { return this->n > 1 ? this->m2 / (this->n - 1) : NAN; }
+	double stddev() const noexcept { return std::sqrt(this->variance()); }
+
+private:
+	RollingBuffer buffer;
+	size_t n = 0;
+	double m = 0.0;
+	double m2 = 0.0;
+};
+
+
+/// <summary>
+/// Rolling min and max over a fixed window using monotonic deques, amortized O(1) per push
+/// </summary>
+class RollingMinMax
+{
+public:
+	explicit RollingMinMax(size_t window);
+
+	void push(double value);
+	void clear();
+
+	bool ready() const noexcept { return this->sequence >= this->window; }
+	double min() const noexcept { return this->min_deque.empty() ? NAN : this->min_deque.front().second; }
+	double max() const noexcept { return this->max_deque.empty() ? NAN : this->max_deque.front().second; }
+
+private:
+	size_t window;
+	size_t sequence = 0;
+	std::deque<std::pair<size_t, double>> min_deque;
+	std::deque<std::pair<size_t, double>> max_deque;
+};
+
+
+/// <summary>
+/// Drawdown of a value series relative to its running peak. With a window of 0 the peak is the
+/// all time high (underwater curve), otherwise the peak is the max of the trailing window.
+/// </summary>
+class RollingDrawdown
+{
+public:
+	explicit RollingDrawdown(size_t window = 0) : peak(window ? window : 1), window(window) {}
+
+	void push(double value);
+	void clear();
+
+	double drawdown() const noexcept { return this->current; }
+	double max_drawdown() const noexcept { return this->worst; }
+
+private:
+	RollingMinMax peak;
+	size_t window;
+	double all_time_high = -std::numeric_limits<double>::infinity();
+	double current = NAN;
+	double worst = 0.0;
+};
+
+
+/// <summary>
+/// Rolling annualized volatility and sharpe ratio of a value series (i.e. nlv). Values are
+/// converted to simple returns on push.
+/// </summary>
+class RollingSharpe
+{
+public:
+	explicit RollingSharpe(size_t window, double annualization = NEXUS_ANNUALIZATION_FACTOR)
+		: returns(window), annualization(annualization) {}
+
+	void push(double value);
+	void clear();
+
+	bool ready() const noexcept { return this->returns.ready(); }
+	double volatility() const noexcept;
+	double sharpe() const noexcept;
+
+private:
+	RollingVariance returns;
+	double annualization;
+	double previous = NAN;
+};
+
+
+/// <summary>
+/// Rolling annualized volatility of the returns of a value series. Output is aligned with the input,
+/// bars before the window is filled are NAN.
+/// </summary>
+std::vector<double> nexus_rolling_volatility(std::span<const double> values, size_t window);
+
+/// <summary>
+/// Rolling annualized sharpe ratio of the returns of a value series, aligned with the input.
+/// </summary>
+std::vector<double> nexus_rolling_sharpe(std::span<const double> values, size_t window);
+
+/// <summary>
+/// Pct drawdown of a value series from its all time high (window = 0) or trailing window high.
+/// </summary>
+std::vector<double> nexus_underwater(std::span<const double> values, size_t window = 0);
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Hydra.h"
+#include "NexusRollingStats.h"
+
+
+/// <summary>
+/// Statistics a rolling window node can compute over the last period bars of a column
+/// </summary>
+enum class NexusWindowType : uint8_t
+{
+	SMA,		///< mean
+	EMA,		///< exponential moving average with alpha = 2 / (period + 1) seeded at the oldest value of the window
+	STD,		///< sample standard deviation
+	ZSCORE,		///< (x - mean) / std of the newest value
+	MIN,		///< minimum
+	MAX,		///< maximum
+	RANK		///< fraction of the window strictly below the newest value, in [0, 1]
+};
+
+extern const std::vector<std::string> nexus_window_strings;
+
+
+/// <summary>
+/// A window over a column as it is stored in the column of an asset lambda chain element, i.e. "SMA(close,20)"
+/// </summary>
+struct NexusWindowSpec
+{
+	NexusWindowType type = NexusWindowType::SMA;
+	std::string column;
+	int period = 1;
+};
+
+
+/// <summary>
+/// Format a window spec as a chain column
+/// </summary>
+std::string nexus_window_column(NexusWindowSpec const& spec);
+
+
+/// <summary>
+/// Parse a chain column produced by nexus_window_column
+/// </summary>
+/// <returns>the spec, nullopt if the column is a plain column name</returns>
+std::optional<NexusWindowSpec> nexus_parse_window_column(std::string const& column);
+
+
+/// <summary>
+/// Rolling statistic of a column with per asset state built on NexusRollingStats. Each bar the newest value is
+/// pushed and the oldest evicted, so the statistic updates in O(1) (RANK in O(log period) plus a shift) instead
+/// of reading period rows. The state remembers the asset row it was last updated at, the row of the current bar
+/// is found in the asset's datetime index. Unless the asset moved exactly one row since (first use, bars it was
+/// not evaluated on, a restart of the exchange) its window is rebuilt from the last period rows, which gives the
+/// same value as the incremental update. The states are sharded by asset index so assets evaluated in parallel
+/// rarely wait on each other.
+/// </summary>
+class NexusRollingWindow
+{
+public:
+	/// <param name="row">row the window ends at, 0 for the current bar</param>
+	NexusRollingWindow(NexusWindowType type, size_t column_index, int period, ExchangePtr const exchange, int row = 0);
+
+	/// <summary>
+	/// Value of the window for the current bar of the exchange, repeated calls in the same bar are cached
+	/// </summary>
+	/// <returns>window statistic, nan while the asset has less than period bars of history</returns>
+	double value(AssetPtr const& asset);
+
+	NexusWindowType get_type() const noexcept { return this->type; }
+	size_t get_column_index() const noexcept { return this->column_index; }
+	int get_period() const noexcept { return this->period; }
+
+private:
+	struct State
+	{
+		State(NexusWindowType type, size_t period);
+
+		RollingBuffer window;						///< last period values
+		std::optional<RollingVariance> moments;		///< SMA, STD, ZSCORE
+		std::optional<RollingMinMax> extremes;		///< MIN, MAX
+		std::vector<double> sorted;					///< window values in order for RANK
+		double ema = 0.0;
+		long long row = -1;							///< asset row the window ends at, -1 before the first push
+		double result = 0.0;
+	};
+
+	struct alignas(64) Shard
+	{
+		std::mutex mutex;
+		std::unordered_map<size_t, State> states;
+	};
+
+	static constexpr size_t shard_count = 64;
+
+	double newest(State const& state, size_t back) const;
+
+	/// <summary>
+	/// Row of the current bar in the asset's datetime index, the last row at or before the exchange datetime
+	/// </summary>
+	long long current_row(AssetPtr const& asset) const;
+
+	void push(State& state, double x) const;
+	void rebuild(State& state, AssetPtr const& asset) const;
+	double result(State const& state) const;
+
+	NexusWindowType type;
+	size_t column_index;
+	size_t period;
+	int row;
+	ExchangePtr exchange;
+	std::array<Shard, shard_count> shards;
+};
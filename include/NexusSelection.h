@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "AgisEnums.h"
+
+
+/// <summary>
+/// Partial selection for the N largest / N smallest / N extreme exchange queries. Instead of letting the
+/// exchange view sort the whole universe every bar, the values outside of the selection are masked to nan
+/// so the engine only orders the selected assets. Non finite values (filtered out, unavailable or still
+/// warming up) are dropped in the same pass that gathers the candidates.
+/// </summary>
+class NexusSelection
+{
+public:
+	/// <summary>
+	/// Mask every value that can not be part of the query result to nan
+	/// </summary>
+	/// <param name="values">cross sectional values, modified in place</param>
+	/// <param name="query_type">exchange query type, Default leaves the values untouched</param>
+	/// <param name="N">number of assets to select from each side</param>
+	void select(std::vector<double>& values, ExchangeQueryType query_type, int N);
+
+private:
+	/// <summary>
+	/// (value, position) of the finite values, reused between bars to avoid reallocating every call
+	/// </summary>
+	std::vector<std::pair<double, size_t>> candidates;
+};
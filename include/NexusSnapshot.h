@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+namespace fs = std::filesystem;
+
+
+/// <summary>
+/// Versioned binary snapshot of an env state document. The layout mirrors the json tree but every value is
+/// tagged and length prefixed, so reading it is a single pass over the file without tokenizing or number
+/// parsing. Strings are referenced in place from the file buffer instead of being copied into the document,
+/// and arrays and objects carry their byte size so a reader can skip a subtree without decoding it.
+///
+///		header:  "NXSS" | uint32 version | uint64 payload size | uint64 payload hash
+///		value:   uint8 tag | payload of the tag
+///		string:  uint32 length | bytes | '\0'
+///		array:   uint32 count | uint64 byte size of the elements | values
+///		object:  uint32 count | uint64 byte size of the members | (string, value) pairs
+///
+/// Integers and doubles are stored as 8 byte little endian. Any other version is rejected, json stays
+/// the export format and the fallback for envs saved before snapshots existed.
+/// </summary>
+class NexusSnapshot
+{
+public:
+	static constexpr uint32_t version = 1;
+
+	/// <summary>
+	/// Encode a document into the snapshot format, header included
+	/// </summary>
+	static std::string encode(rapidjson::Value const& value);
+
+	/// <summary>
+	/// Encode a document and write it next to the target before renaming it in place, so a failed save
+	/// never leaves a truncated snapshot behind
+	/// </summary>
+	static void write(fs::path const& path, rapidjson::Value const& value);
+
+	/// <summary>
+	/// Read a snapshot, throws if the file can't be read, is corrupt or of another version
+	/// </summary>
+	static std::unique_ptr<NexusSnapshot> read(fs::path const& path);
+
+	/// <summary>
+	/// Decoded document, its strings point into the snapshot buffer and are valid as long as the snapshot
+	/// </summary>
+	rapidjson::Document const& document() const noexcept { return this->doc; }
+
+private:
+	NexusSnapshot() = default;
+
+	std::vector<char> buffer;
+	rapidjson::Document doc;
+};
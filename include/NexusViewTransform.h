@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Exchange.h"
+
+
+/// <summary>
+/// Cross sectional transforms applied to the weights of an exchange view before allocation
+/// </summary>
+enum class NexusTransformType : uint8_t
+{
+	RANK,		///< percentile rank in [0, 1], ties get the average rank
+	ZSCORE,		///< (x - mean) / std
+	DEMEAN,		///< x - mean
+	WINSORIZE	///< clip x to mean +/- param * std
+};
+
+extern const std::vector<std::string> nexus_transform_strings;
+
+
+/// <summary>
+/// Parse a transform name from nexus_transform_strings
+/// </summary>
+std::optional<NexusTransformType> nexus_transform_type(std::string const& name);
+
+
+/// <summary>
+/// Single cross sectional transform over an exchange view, applied in place. The reductions are one pass
+/// over a contiguous copy of the values and rank is an argsort, both on thread local buffers that are
+/// reused between bars so nothing allocates once the universe size has been seen.
+/// </summary>
+class NexusViewTransform
+{
+public:
+	NexusViewTransform(NexusTransformType type, double param = 3.0) : type(type), param(param) {}
+
+	void apply(ExchangeView& view) const;
+
+	NexusTransformType get_type() const noexcept { return this->type; }
+	double get_param() const noexcept { return this->param; }
+
+private:
+	NexusTransformType type;
+	double param;
+};
@@ -14,5 +14,6 @@ public:
 	static ads::CDockWidget* create_portfolios_widget(MainWindow* w);
 	static ads::CDockWidget* create_exchanges_widget(MainWindow* w);
 	static ads::CDockWidget* create_file_system_tree_widget(MainWindow* w);
+	static ads::CDockWidget* create_build_output_widget(MainWindow* w);
 
 };
\ No newline at end of file
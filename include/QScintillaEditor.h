@@ -70,6 +70,7 @@ class QScintillaEditor : public QMainWindow
 public:
     QScintillaEditor(ads::CDockWidget* DockWidget);
     void loadFile(const QString& fileName);
+    void goto_line(int line);
 
     QString get_file_name() const { return curFile; }
     int get_id() const { return this->DockWidget->get_id(); }
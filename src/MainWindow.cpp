@@ -31,10 +31,14 @@
 #include <QMap>
 #include <QElapsedTimer>
 #include <QEventLoop>
+#include <QFutureWatcher>
+#include <QTimer>
 #include <QDateTime>
 #include "AgisPointers.h"
 
 #include "MainWindow.h"
+#include "NexusBuildOutput.h"
+#include "NexusSnapshot.h"
 #include "ui_MainWindow.h"
 
 #include "AutoHideDockContainer.h"
@@ -47,6 +51,7 @@
 #include "NexusPopups.h"
 #include "NexusTree.h"
 #include "NexusNode.h"
+#include "NexusPreview.h"
 #include "NexusErrors.h"
 #include "NexusHelpers.h"
 #include "NexusPortfolio.h"
@@ -151,6 +156,11 @@ MainWindow::MainWindow(QWidget* parent):
     PortfoliosWidget->setFeature(ads::CDockWidget::DockWidgetClosable, false);
     container = this->DockManager->addAutoHideDockWidget(ads::SideBarLeft, PortfoliosWidget);
     container->setSize(200);
+
+    // create build output widget, hidden until the first compile
+    this->BuildOutputWidget = NexusWidgetFactory::create_build_output_widget(this);
+    this->DockManager->addDockWidget(ads::BottomDockWidgetArea, this->BuildOutputWidget);
+    this->BuildOutputWidget->toggleView(false);
     qDebug() << "INIT BASE WIDGETS COMPLETE";
 
     applyVsStyle();
@@ -394,6 +404,11 @@ void MainWindow::setup_toolbar()
     ui->actionSaveState->setIcon(svgIcon("./images/save.svg"));
     ui->toolBar->addAction(ui->actionRestoreState);
     ui->actionRestoreState->setIcon(svgIcon("./images/restore.svg"));
+    QAction* export_action = new QAction("Export", ui->toolBar);
+    export_action->setToolTip("Export the saved env state as env_settings.json");
+    export_action->setIcon(svgIcon("./images/json.png"));
+    connect(export_action, &QAction::triggered, this, &MainWindow::export_state);
+    ui->toolBar->addAction(export_action);
     ui->toolBar->addSeparator();
 
     //QAction* a = new QAction("New Console", ui->toolBar);
@@ -459,6 +474,13 @@ void MainWindow::setup_command_bar()
     connect(a, &QAction::triggered, this, &MainWindow::__run_compile);
     ui->toolBar->addAction(a);
 
+    a = new QAction("PGO Compile", ui->toolBar);
+    a->setProperty("Floating", true);
+    a->setToolTip("Compile Agis strategies with profile guided optimization from a backtest");
+    a->setIcon(svgIcon("./images/console.png"));
+    connect(a, &QAction::triggered, this, &MainWindow::__run_pgo_compile);
+    ui->toolBar->addAction(a);
+
     a = new QAction("Link", ui->toolBar);
     a->setProperty("Floating", true);
     a->setToolTip("Link Agis strategies");
@@ -579,6 +601,22 @@ AgisResult<bool> MainWindow::save_state()
 }
 
 
+//============================================================================
+void MainWindow::export_state()
+{
+    auto res = this->nexus_env.export_env_json();
+    if (!res) {
+        QMessageBox::critical(this, "Export", QString::fromStdString(res.error().what()));
+        return;
+    }
+    QMessageBox::information(
+        this,
+        "Export",
+        "Exported env state to " + QString::fromStdString(this->nexus_env.get_env_settings_path().string())
+    );
+}
+
+
 //============================================================================
 std::optional<fs::path> get_editor_by_id(rapidjson::Value const& open_editors, int id)
 {
@@ -600,9 +638,46 @@ MainWindow::restore_exchanges(Document const& j)
 {
     // Restore Nexus env from the given json
     auto startTime = std::chrono::high_resolution_clock::now();
-    AGIS_ASSIGN_OR_RETURN(res, this->nexus_env.restore_exchanges(j));
+
+    // hydra parses every exchange in one call, it runs on a worker so the window keeps painting and the
+    // progress bar counts the seconds until it returns. User input is held back until the env is restored.
+    using RestoreResult = std::expected<bool, AgisException>;
+    QEventLoop eventLoop;
+    QFutureWatcher<RestoreResult> watcher;
+    connect(&watcher, &QFutureWatcher<RestoreResult>::finished, &eventLoop, &QEventLoop::quit);
+    auto format = ProgressBar->format();
+    QTimer ticker;
+    connect(&ticker, &QTimer::timeout, this, [this, startTime]() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::high_resolution_clock::now() - startTime
+        ).count();
+        ProgressBar->setFormat(QString("Loading exchanges (%1 s)").arg(elapsed));
+    });
+    ProgressBar->setFormat("Loading exchanges");
+    ticker.start(1000);
+    watcher.setFuture(QtConcurrent::run([this, &j]() -> RestoreResult {
+        try {
+            return this->nexus_env.restore_exchanges(j);
+        }
+        catch (std::exception& e) {
+            return std::unexpected<AgisException>(AGIS_EXCEP(std::string(e.what())));
+        }
+    }));
+    if (!watcher.isFinished()) eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+    ticker.stop();
+    ProgressBar->setFormat(format);
+    AGIS_ASSIGN_OR_RETURN(res, watcher.result());
+
     auto endTime = std::chrono::high_resolution_clock::now();
     auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    auto hydra = this->nexus_env.get_hydra();
+    for (auto const& exchange_id : hydra->get_exchanges().get_exchange_ids())
+    {
+        auto exchange = hydra->get_exchange(exchange_id);
+        if (!exchange.has_value()) continue;
+        qDebug() << "EXCHANGE " << QString::fromStdString(exchange_id) << " RESTORED WITH "
+            << exchange.value()->get_assets().size() << " ASSETS";
+    }
     qDebug() << "EXCHANGES RESTORE COMPLETE IN " << QString::number(durationMs) << " Ms";
     return true;
 }
@@ -665,25 +740,57 @@ void MainWindow::restore_state()
     ProgressBar->setMaximum(9);
     ProgressBar->setValue(0);
     qDebug() << "==== Restoring state ====";
-    // Load in env settings
-    auto env_settings = this->nexus_env.get_env_settings_path();
-    std::ifstream env_settings_file(env_settings.string());
-
-    if (!env_settings_file.is_open()) {
-        QMessageBox::critical(nullptr, "Error", "Failed to find env state");
-        return;
+    // Load in env state, the binary snapshot if there is one and the json of older envs otherwise
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<NexusSnapshot> snapshot;
+    auto env_snapshot = this->nexus_env.get_env_snapshot_path();
+    std::string snapshot_error;
+    if (fs::exists(env_snapshot)) {
+        try {
+            snapshot = NexusSnapshot::read(env_snapshot);
+        }
+        catch (std::exception& e) {
+            qDebug() << "Failed to read env snapshot, falling back to json: " << e.what();
+            snapshot_error = e.what();
+        }
     }
-    ProgressBar->setValue(1);
-    std::string jsonString((std::istreambuf_iterator<char>(env_settings_file)), std::istreambuf_iterator<char>());
-    Document j;
-    try {
+    Document json;
+    if (!snapshot) {
+        auto env_settings = this->nexus_env.get_env_settings_path();
+        std::ifstream env_settings_file(env_settings.string());
+
+        if (!env_settings_file.is_open()) {
+            QMessageBox::critical(nullptr, "Error", "Failed to find env state");
+            return;
+        }
+
+        // saves only write the snapshot, a json older than it is the state of an earlier save or export
+        std::error_code json_ec, snapshot_ec;
+        auto json_time = fs::last_write_time(env_settings, json_ec);
+        auto snapshot_time = fs::last_write_time(env_snapshot, snapshot_ec);
+        if (!snapshot_error.empty() && !json_ec && !snapshot_ec && json_time < snapshot_time) {
+            QMessageBox::warning(
+                nullptr,
+                "Restore",
+                "The env snapshot could not be read (" + QString::fromStdString(snapshot_error) + ").\n"
+                "Restoring from env_settings.json instead, which is older than the snapshot. "
+                "Changes saved after it was written are missing."
+            );
+        }
+        ProgressBar->setValue(1);
+        std::string jsonString((std::istreambuf_iterator<char>(env_settings_file)), std::istreambuf_iterator<char>());
         // parse string into rapid json document
-        j.Parse(jsonString.c_str());
+        json.Parse(jsonString.c_str());
+        if (json.HasParseError()) {
+            QMessageBox::critical(nullptr, "Error", "Failed to parse env state");
+            return;
+        }
     }
-    catch (std::exception& e) {
-		QMessageBox::critical(nullptr, "Error", "Failed to parse env state");
-		return;
-	}
+    // strings of a snapshot document point into the snapshot, it lives until the restore is done
+    Document const& j = snapshot ? snapshot->document() : json;
+    auto loadEnd = std::chrono::high_resolution_clock::now();
+    qDebug() << "ENV STATE LOADED FROM " << (snapshot ? "SNAPSHOT" : "JSON") << " IN "
+        << QString::number(std::chrono::duration_cast<std::chrono::milliseconds>(loadEnd - loadStart).count()) << " Ms";
     ProgressBar->setValue(2);
 
     // Reset window geometry
@@ -771,9 +878,6 @@ void MainWindow::onFileDoubleClicked(const QModelIndex& index)
 
     if (QFileSystemModel const* fileSystemModel = dynamic_cast<QFileSystemModel const*>(model))
     {
-        // Get the previous editor, if we fail to create the new one restore to this
-        auto last_editor = this->LastDockedEditor;
-
         QString file_path = fileSystemModel->filePath(index);
         std::filesystem::path pathToCheck(file_path.toStdString());
         if (std::filesystem::is_directory(pathToCheck)) {
@@ -784,28 +888,39 @@ void MainWindow::onFileDoubleClicked(const QModelIndex& index)
             QMessageBox::critical(this, "Error", "File is already open");
             return;
         }
+        this->open_file_editor(file_path);
+    }
+}
 
-        auto a = new QAction("Create Docked Editor");
-        a->setProperty("Floating", false);
-        if (!LastDockedEditor)
-        {
-            a->setProperty("Tabbed", false);
-        }
-        connect(a, &QAction::triggered, this, &MainWindow::create_editor);
-        a->trigger();
 
-        // Get the editor that was just created and attempt to fload the file that was clicked
-        auto editor = dynamic_cast<QScintillaEditor*>(LastDockedEditor->widget());
-        try {
-            editor->loadFile(file_path);
-        }
-        catch (std::exception& e)
-        {
-            LastDockedEditor->closeDockWidget();
-            this->LastDockedEditor = last_editor;
-            this->nexus_env.remove_editor(file_path);
-        }
+//============================================================================
+QScintillaEditor* MainWindow::open_file_editor(QString const& file_path)
+{
+    // Get the previous editor, if we fail to create the new one restore to this
+    auto last_editor = this->LastDockedEditor;
+
+    auto a = new QAction("Create Docked Editor");
+    a->setProperty("Floating", false);
+    if (!LastDockedEditor)
+    {
+        a->setProperty("Tabbed", false);
+    }
+    connect(a, &QAction::triggered, this, &MainWindow::create_editor);
+    a->trigger();
+
+    // Get the editor that was just created and attempt to fload the file that was clicked
+    auto editor = dynamic_cast<QScintillaEditor*>(LastDockedEditor->widget());
+    try {
+        editor->loadFile(file_path);
+    }
+    catch (std::exception& e)
+    {
+        LastDockedEditor->closeDockWidget();
+        this->LastDockedEditor = last_editor;
+        this->nexus_env.remove_editor(file_path);
+        return nullptr;
     }
+    return editor;
 }
 
 //============================================================================
@@ -1167,10 +1282,19 @@ void MainWindow::extract_flow_graphs()
 //============================================================================
 void MainWindow::__run_lambda()
 {
+    // the run would backtest the libraries the build is replacing and hold up its output until it returns
+    if (this->build_output->is_running())
+    {
+        QMessageBox::information(this, "Run", "Wait for the running build to finish before running");
+        return;
+    }
     this->ProgressBar->setValue(0);
     this->ProgressBar->setMaximum(6);
 
     this->extract_flow_graphs();
+    // previews read the exchanges the run is stepping, they evaluate again once the history is saved
+    std::optional<NexusPreviewSuspend> suspend_previews;
+    suspend_previews.emplace();
     QEventLoop eventLoop;
     ProgressBar->setValue(1);
     QFuture<std::variant<long long, std::string>> future = QtConcurrent::run([this, &eventLoop]() -> std::variant<long long, std::string> {
@@ -1230,6 +1354,7 @@ void MainWindow::__run_lambda()
     // analyze the portfolio historys
     ProgressBar->setValue(4);
     this->nexus_env.__save_history();
+    suspend_previews.reset();
     ProgressBar->setValue(5);
     emit new_hydra_run();
     ProgressBar->setValue(6);
@@ -1237,16 +1362,130 @@ void MainWindow::__run_lambda()
 }
 
 
+//============================================================================
+bool MainWindow::start_compile(NexusPgoPhase phase)
+{
+    // generating the code needs hydra and stays on the GUI thread, the build runs as child processes
+    NexusBuildPlan plan;
+    try {
+        plan = this->nexus_env.__prepare_compile(phase);
+    }
+    catch (std::exception& e) {
+        QMessageBox::critical(nullptr, "Error", e.what());
+        return false;
+    }
+    this->BuildOutputWidget->toggleView(true);
+    this->build_output->start(std::move(plan));
+    return true;
+}
+
+
 //============================================================================
 void MainWindow::__run_compile()
 {
-    NEXUS_TRY(this->nexus_env.__compile());
+    if (this->build_output->is_running())
+    {
+        QMessageBox::information(this, "Compile", "A build is already running");
+        return;
+    }
+    this->start_compile(NexusPgoPhase::NONE);
+}
+
+
+//============================================================================
+void MainWindow::__run_pgo_compile()
+{
+    if (this->build_output->is_running())
+    {
+        QMessageBox::information(this, "PGO Compile", "A build is already running");
+        return;
+    }
+
+    // regular build and its backtest, then the instrumented build collecting the profile, then the optimized build.
+    // Each phase starts from on_build_finished once the previous one has run its backtest.
+    this->extract_flow_graphs();
+    this->pgo_report = NexusPgoReport();
+    if (this->start_compile(NexusPgoPhase::NONE)) this->pgo_phase = NexusPgoPhase::NONE;
+}
+
+
+//============================================================================
+void MainWindow::on_build_finished(QStringList failed, bool cancelled)
+{
+    auto phase = this->pgo_phase;
+    this->pgo_phase = std::nullopt;
+    if (cancelled) return;
+    std::vector<std::string> failed_targets;
+    for (auto const& target : failed) failed_targets.push_back(target.toStdString());
+    if (!phase.has_value())
+    {
+        NEXUS_TRY(this->nexus_env.__finish_compile(this->build_output->get_plan(), failed_targets));
+        return;
+    }
+
+    // the backtests block the GUI like a regular run does
+    try {
+        this->nexus_env.__finish_compile(this->build_output->get_plan(), failed_targets);
+        NexusPreviewSuspend suspend_previews;
+        this->pgo_report.backtest_ms[static_cast<size_t>(phase.value())] = this->nexus_env.__run_pgo_phase(phase.value());
+    }
+    catch (std::exception& e) {
+        // strategies were relinked or unloaded along the way
+        this->portfolio_tree->relink_tree(this->nexus_env.get_portfolio_ids());
+        QMessageBox::critical(nullptr, "Error", e.what());
+        return;
+    }
+    if (phase.value() != NexusPgoPhase::USE)
+    {
+        auto next = static_cast<NexusPgoPhase>(static_cast<uint8_t>(phase.value()) + 1);
+        if (this->start_compile(next)) this->pgo_phase = next;
+        else this->portfolio_tree->relink_tree(this->nexus_env.get_portfolio_ids());
+        return;
+    }
+
+    // the last backtest ran the strategies as they are now linked, keep its results like a regular run
+    this->pgo_report.candles = this->nexus_env.get_candle_count();
+    this->portfolio_tree->relink_tree(this->nexus_env.get_portfolio_ids());
+    this->nexus_env.__save_history();
+    emit new_hydra_run();
+    QMessageBox::information(this, "PGO Build", QString::fromStdString(nexus_pgo_summary(this->pgo_report)), QMessageBox::Ok);
+}
+
+
+//============================================================================
+void MainWindow::on_build_diagnostic_activated(QString file, int line, QString strategy_id)
+{
+    // code generated from a flow graph is fixed in its node editor, anything else is opened at the line
+    auto path = std::filesystem::path(file.toStdString());
+    bool generated = path.stem().string().ends_with("_CPP")
+        || path.parent_path().filename() == "registry";
+    if (generated && !strategy_id.isEmpty())
+    {
+        auto strategy = this->nexus_env.__get_strategy(strategy_id.toStdString());
+        if (strategy.has_value() && strategy.value()->get_strategy_type() == AgisStrategyType::FLOW)
+        {
+            auto DockWidget = this->create_node_editor_widget(strategy_id);
+            if (DockWidget) this->place_widget(DockWidget, this->build_output);
+            return;
+        }
+    }
+
+    if (!std::filesystem::exists(path)) return;
+    auto editor = this->nexus_env.get_editor(file);
+    QScintillaEditor* w = editor.has_value() ? editor.value() : this->open_file_editor(file);
+    if (w) w->goto_line(line);
 }
 
 
 //============================================================================
 void MainWindow::__run_link()
 {
+    // cmake is still writing the libraries the link would copy and load
+    if (this->build_output->is_running())
+    {
+        QMessageBox::information(this, "Link", "Wait for the running build to finish before linking");
+        return;
+    }
     NEXUS_TRY(this->nexus_env.__link());
     auto portfolio_ids = this->nexus_env.get_portfolio_ids();
     this->portfolio_tree->relink_tree(portfolio_ids);
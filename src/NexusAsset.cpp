@@ -125,7 +125,19 @@ void NexusAsset::load_asset_data()
 {
     this->dt_index = asset->__get_dt_index(false);
     this->dt_index_str = asset->__get_dt_index_str(false);
-    this->data = asset->__get__data();
+    // a cached exchange serves the table from the mapped file, only the pages of this asset are read. Until the
+    // background write of the cache is done the data is copied
+    this->asset_cache = this->nexus_env->get_asset_cache(asset->get_asset_id());
+    auto mapped = this->asset_cache ? this->asset_cache->get_asset(asset->get_asset_id()) : nullptr;
+    if (mapped && mapped->rows == static_cast<size_t>(asset->get_rows()) && mapped->columns.size() == static_cast<size_t>(asset->get_cols())) {
+        this->asset_data.clear();
+        this->data = mapped->data;
+    }
+    else {
+        this->asset_cache = nullptr;
+        this->asset_data = asset->__get__data();
+        this->data = this->asset_data;
+    }
     this->column_names = asset->get_column_names();
     auto& headers = asset->get_headers();
 
@@ -0,0 +1,66 @@
+#include "NexusAvailability.h"
+
+#include <cmath>
+
+#include "NexusLambdaKernel.h"
+
+
+//============================================================================
+NexusAvailability& NexusAvailability::instance()
+{
+	static NexusAvailability availability;
+	return availability;
+}
+
+
+//============================================================================
+NexusAvailability::Bitmap NexusAvailability::get(
+	void const* exchange,
+	long long datetime,
+	std::vector<AssetPtr> const& slots,
+	size_t column_index,
+	int warmup)
+{
+	auto key = std::make_pair(exchange, warmup);
+	{
+		std::shared_lock lock(this->mutex);
+		auto it = this->entries.find(key);
+		if (it != this->entries.end() && it->second.datetime == datetime && it->second.size == slots.size()) {
+			return it->second.bitmap;
+		}
+	}
+
+	std::unique_lock lock(this->mutex);
+	auto& entry = this->entries[key];
+	if (entry.bitmap && entry.datetime == datetime && entry.size == slots.size()) return entry.bitmap;
+
+	// the universe was laid out differently or the exchange was reset and runs again, start over and probe
+	// every asset
+	if (entry.size != slots.size() || datetime < entry.datetime) {
+		entry.bits.assign((slots.size() + 63) / 64, 0);
+		entry.size = slots.size();
+	}
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		uint64_t mask = uint64_t(1) << (i & 63);
+		auto& word = entry.bits[i >> 6];
+		if (!slots[i]) {
+			// stopped streaming, a relisting has to warm up again
+			word &= ~mask;
+			continue;
+		}
+		if (word & mask) continue;
+		if (warmup == 0 || !std::isnan(nexus_load_feature(slots[i], column_index, -warmup))) word |= mask;
+	}
+	entry.datetime = datetime;
+	entry.bitmap = std::make_shared<const std::vector<uint64_t>>(entry.bits);
+	return entry.bitmap;
+}
+
+
+//============================================================================
+void NexusAvailability::clear()
+{
+	std::unique_lock lock(this->mutex);
+	this->entries.clear();
+}
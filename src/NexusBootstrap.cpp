@@ -0,0 +1,194 @@
+#include "NexusBootstrap.h"
+#include "NexusRollingStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+
+//============================================================================
+static inline uint64_t splitmix64(uint64_t x) noexcept
+{
+	x += 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+
+//============================================================================
+uint64_t nexus_counter_rng(uint64_t key, uint64_t counter) noexcept
+{
+	// two rounds of splitmix over the key/counter pair, cheap and statistically sound for resampling
+	return splitmix64(splitmix64(key) ^ counter);
+}
+
+
+//============================================================================
+NexusBootstrap::NexusBootstrap(
+	size_t resamples_,
+	size_t block_size_,
+	double confidence_,
+	uint64_t seed_) :
+	resamples(resamples_),
+	block_size(std::max<size_t>(1, block_size_)),
+	confidence(confidence_),
+	seed(seed_)
+{
+}
+
+
+//============================================================================
+struct BootstrapSeries
+{
+	// prefix sums of returns and squared returns over the series wrapped by one block
+	std::vector<double> sum;
+	std::vector<double> sum_sq;
+	size_t n = 0;
+};
+
+
+//============================================================================
+static BootstrapSeries build_series(std::span<const double> nlv, size_t block_size)
+{
+	BootstrapSeries series;
+	std::vector<double> returns;
+	returns.reserve(nlv.size());
+	for (size_t i = 1; i < nlv.size(); i++)
+	{
+		if (nlv[i - 1] == 0.0 || std::isnan(nlv[i]) || std::isnan(nlv[i - 1])) continue;
+		returns.push_back((nlv[i] - nlv[i - 1]) / nlv[i - 1]);
+	}
+	series.n = returns.size();
+	if (series.n == 0) return series;
+
+	// wrap the series so circular blocks are contiguous ranges of the prefix sums
+	size_t wrapped = series.n + block_size;
+	series.sum.resize(wrapped + 1, 0.0);
+	series.sum_sq.resize(wrapped + 1, 0.0);
+	for (size_t i = 0; i < wrapped; i++)
+	{
+		double r = returns[i % series.n];
+		series.sum[i + 1] = series.sum[i] + r;
+		series.sum_sq[i + 1] = series.sum_sq[i] + r * r;
+	}
+	return series;
+}
+
+
+//============================================================================
+static BootstrapInterval percentile_interval(std::vector<double>& samples, double point, double confidence)
+{
+	BootstrapInterval interval;
+	interval.point = point;
+
+	// drop degenerate resamples (i.e. zero variance) before taking percentiles
+	samples.erase(std::remove_if(samples.begin(), samples.end(), [](double x) { return !std::isfinite(x); }), samples.end());
+	if (samples.empty()) {
+		interval.lower = NAN;
+		interval.upper = NAN;
+		return interval;
+	}
+	double alpha = (1.0 - confidence) / 2.0;
+	size_t lo = static_cast<size_t>(alpha * (samples.size() - 1));
+	size_t hi = static_cast<size_t>((1.0 - alpha) * (samples.size() - 1));
+	std::nth_element(samples.begin(), samples.begin() + lo, samples.end());
+	interval.lower = samples[lo];
+	std::nth_element(samples.begin() + lo, samples.begin() + hi, samples.end());
+	interval.upper = samples[hi];
+	return interval;
+}
+
+
+//============================================================================
+std::vector<BootstrapResult> NexusBootstrap::run(std::vector<std::span<const double>> const& nlv_series) const
+{
+	size_t strategy_count = nlv_series.size();
+	std::vector<BootstrapResult> results(strategy_count);
+	if (strategy_count == 0 || this->resamples == 0) return results;
+
+	std::vector<BootstrapSeries> series(strategy_count);
+	std::for_each(std::execution::par, series.begin(), series.end(), [&](BootstrapSeries& s) {
+		size_t i = &s - series.data();
+		s = build_series(nlv_series[i], this->block_size);
+	});
+
+	// output buffers for every (strategy, resample) pair
+	std::vector<double> means(strategy_count * this->resamples, NAN);
+	std::vector<double> stds(strategy_count * this->resamples, NAN);
+
+	// split the work into fixed size chunks of resamples so the scheduler can balance strategies of
+	// different lengths, the chunking does not affect the result as every draw is keyed by its counter
+	constexpr size_t chunk_size = 256;
+	size_t chunks_per_strategy = (this->resamples + chunk_size - 1) / chunk_size;
+	std::vector<size_t> tasks(strategy_count * chunks_per_strategy);
+	std::iota(tasks.begin(), tasks.end(), 0);
+
+	std::for_each(std::execution::par, tasks.begin(), tasks.end(), [&](size_t task) {
+		size_t strategy = task / chunks_per_strategy;
+		size_t chunk = task % chunks_per_strategy;
+		auto const& s = series[strategy];
+		if (s.n < 2) return;
+
+		uint64_t key = this->seed ^ (static_cast<uint64_t>(strategy) << 32);
+		size_t block = std::min(this->block_size, s.n);
+		size_t blocks = (s.n + block - 1) / block;
+		size_t begin = chunk * chunk_size;
+		size_t end = std::min(begin + chunk_size, this->resamples);
+		double const* sum = s.sum.data();
+		double const* sum_sq = s.sum_sq.data();
+
+		for (size_t resample = begin; resample < end; resample++)
+		{
+			double total = 0.0;
+			double total_sq = 0.0;
+			size_t remaining = s.n;
+			uint64_t counter = static_cast<uint64_t>(resample) * blocks;
+			for (size_t b = 0; b < blocks; b++)
+			{
+				size_t start = nexus_counter_rng(key, counter + b) % s.n;
+				size_t len = std::min(block, remaining);
+				total += sum[start + len] - sum[start];
+				total_sq += sum_sq[start + len] - sum_sq[start];
+				remaining -= len;
+			}
+			double mean = total / s.n;
+			double var = (total_sq - s.n * mean * mean) / (s.n - 1);
+			means[strategy * this->resamples + resample] = mean;
+			stds[strategy * this->resamples + resample] = var > 0.0 ? std::sqrt(var) : 0.0;
+		}
+	});
+
+	// reduce each strategy's resamples into percentile intervals
+	double root_annualization = std::sqrt(NEXUS_ANNUALIZATION_FACTOR);
+	std::vector<size_t> strategies(strategy_count);
+	std::iota(strategies.begin(), strategies.end(), 0);
+	std::for_each(std::execution::par, strategies.begin(), strategies.end(), [&](size_t strategy) {
+		auto const& s = series[strategy];
+		if (s.n < 2) return;
+
+		double mean = s.sum[s.n] / s.n;
+		double var = (s.sum_sq[s.n] - s.n * mean * mean) / (s.n - 1);
+		double sigma = var > 0.0 ? std::sqrt(var) : 0.0;
+
+		std::vector<double> returns(this->resamples);
+		std::vector<double> vols(this->resamples);
+		std::vector<double> sharpes(this->resamples);
+		for (size_t i = 0; i < this->resamples; i++)
+		{
+			double m = means[strategy * this->resamples + i];
+			double sd = stds[strategy * this->resamples + i];
+			returns[i] = m * NEXUS_ANNUALIZATION_FACTOR * 100.0;
+			vols[i] = sd * root_annualization * 100.0;
+			sharpes[i] = sd > 0.0 ? (m / sd) * root_annualization : NAN;
+		}
+
+		auto& result = results[strategy];
+		result.annualized_return = percentile_interval(returns, mean * NEXUS_ANNUALIZATION_FACTOR * 100.0, this->confidence);
+		result.annualized_volatility = percentile_interval(vols, sigma * root_annualization * 100.0, this->confidence);
+		result.sharpe = percentile_interval(sharpes, sigma > 0.0 ? (mean / sigma) * root_annualization : NAN, this->confidence);
+		result.valid = true;
+	});
+	return results;
+}
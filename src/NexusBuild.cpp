@@ -0,0 +1,271 @@
+#include "NexusBuild.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <QDebug>
+
+#include "NexusLibrary.h"
+
+
+const std::vector<std::string> nexus_pgo_strings = {
+	"OFF",
+	"GENERATE",
+	"USE"
+};
+
+
+const std::string nexus_pgo_cmake = R"(
+# Profile guided optimization: GENERATE builds instrumented libraries that write their profile to
+# NEXUS_PGO_DIR/<target> when they are unloaded, USE rebuilds them from it with link time optimization
+set(NEXUS_PGO "OFF" CACHE STRING "Profile guided optimization phase: OFF, GENERATE or USE")
+set(NEXUS_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Folder of the profiles")
+if (NOT NEXUS_PGO STREQUAL "OFF")
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT NEXUS_IPO_SUPPORTED OUTPUT NEXUS_IPO_OUTPUT)
+    if (NOT NEXUS_IPO_SUPPORTED)
+        message(WARNING "Link time optimization is not supported: ${NEXUS_IPO_OUTPUT}")
+    endif()
+    get_filename_component(NEXUS_COMPILER_DIR "${CMAKE_CXX_COMPILER}" DIRECTORY)
+    if (MSVC AND NEXUS_PGO STREQUAL "GENERATE")
+        # instrumented dlls import the profiling runtime, Nexus adds this folder to the dll search path
+        find_file(NEXUS_PGORT pgort140.dll HINTS "${NEXUS_COMPILER_DIR}" REQUIRED)
+        file(COPY "${NEXUS_PGORT}" DESTINATION "${NEXUS_PGO_DIR}")
+    endif()
+endif()
+
+function(nexus_pgo_target TARGET)
+    if (NEXUS_PGO STREQUAL "OFF")
+        return()
+    endif()
+    set(PROFILE_DIR "${NEXUS_PGO_DIR}/${TARGET}")
+    file(MAKE_DIRECTORY "${PROFILE_DIR}")
+    if (NEXUS_IPO_SUPPORTED)
+        set_target_properties(${TARGET} PROPERTIES INTERPROCEDURAL_OPTIMIZATION ON)
+    endif()
+
+    if (MSVC)
+        # the counts (.pgc) are written next to the .pgd and merged into it by the optimizing link
+        if (NEXUS_PGO STREQUAL "GENERATE")
+            target_link_options(${TARGET} PRIVATE "/GENPROFILE:PGD=${PROFILE_DIR}/${TARGET}.pgd")
+        else()
+            target_link_options(${TARGET} PRIVATE "/USEPROFILE:PGD=${PROFILE_DIR}/${TARGET}.pgd")
+        endif()
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if (NEXUS_PGO STREQUAL "GENERATE")
+            target_compile_options(${TARGET} PRIVATE "-fprofile-generate=${PROFILE_DIR}" -fprofile-update=atomic)
+            target_link_options(${TARGET} PRIVATE "-fprofile-generate=${PROFILE_DIR}")
+            return()
+        endif()
+        # clang writes raw profiles, merge them into the one the optimized build reads
+        file(GLOB RAW_PROFILES "${PROFILE_DIR}/*.profraw")
+        if (NOT RAW_PROFILES)
+            message(WARNING "No profile for ${TARGET}, building it without one")
+            return()
+        endif()
+        find_program(NEXUS_LLVM_PROFDATA llvm-profdata HINTS "${NEXUS_COMPILER_DIR}" REQUIRED)
+        execute_process(
+            COMMAND "${NEXUS_LLVM_PROFDATA}" merge -o "${PROFILE_DIR}/${TARGET}.profdata" ${RAW_PROFILES}
+            COMMAND_ERROR_IS_FATAL ANY
+        )
+        target_compile_options(${TARGET} PRIVATE "-fprofile-use=${PROFILE_DIR}/${TARGET}.profdata" -Wno-profile-instr-unprofiled)
+        target_link_options(${TARGET} PRIVATE "-fprofile-use=${PROFILE_DIR}/${TARGET}.profdata")
+    else()
+        # strategies run on several threads, the counters are updated atomically so they stay exact.
+        # Functions the profiling run never reached are optimized as usual instead of for size.
+        if (NEXUS_PGO STREQUAL "GENERATE")
+            target_compile_options(${TARGET} PRIVATE "-fprofile-generate=${PROFILE_DIR}" -fprofile-update=atomic)
+            target_link_options(${TARGET} PRIVATE "-fprofile-generate=${PROFILE_DIR}")
+        else()
+            target_compile_options(${TARGET} PRIVATE "-fprofile-use=${PROFILE_DIR}" -fprofile-correction -fprofile-partial-training -Wno-missing-profile)
+            target_link_options(${TARGET} PRIVATE "-fprofile-use=${PROFILE_DIR}")
+        endif()
+    endif()
+endfunction()
+)";
+
+
+//============================================================================
+static std::string quote(std::string const& argument)
+{
+	if (argument.find_first_of(" \t") == std::string::npos) return argument;
+	return "\"" + argument + "\"";
+}
+
+
+//============================================================================
+std::string nexus_build_command(NexusBuildPlan const& plan, NexusBuildStep const& step)
+{
+	std::string build_folder = plan.build_folder.string();
+	std::replace(build_folder.begin(), build_folder.end(), '\\', '/');
+	std::string command = "cd " + quote(build_folder) + " && cmake";
+	for (auto const& argument : step.arguments) command += " " + quote(argument);
+	if (!step.log_file.empty()) {
+		std::string log_file = step.log_file.string();
+		std::replace(log_file.begin(), log_file.end(), '\\', '/');
+		command += " > \"" + log_file + "\" 2>&1";
+	}
+	return command;
+}
+
+
+//============================================================================
+std::vector<std::string> nexus_parallel_build_arguments(std::string const& generator, std::string const& config, size_t jobs)
+{
+	std::vector<std::string> arguments = { "--build", ".", "--config", config, "--parallel", std::to_string(std::max<size_t>(jobs, 1)) };
+
+	// MSBuild keeps building the projects of a solution that don't depend on a failed one by itself
+	if (generator.find("Ninja") != std::string::npos) {
+		arguments.insert(arguments.end(), { "--", "-k", "0" });
+	}
+	else if (generator.find("Makefiles") != std::string::npos) {
+		arguments.insert(arguments.end(), { "--", "-k" });
+	}
+	return arguments;
+}
+
+
+//============================================================================
+std::optional<std::string> nexus_failed_target(std::string_view line, std::vector<std::string> const& targets)
+{
+	bool ninja = line.find("FAILED: ") != std::string_view::npos;
+	bool make = line.find("*** [") != std::string_view::npos;
+	bool msbuild = line.find("error ") != std::string_view::npos && line.find(".vcxproj]") != std::string_view::npos;
+	if (!ninja && !make && !msbuild) return std::nullopt;
+
+	std::string text(line);
+	std::replace(text.begin(), text.end(), '\\', '/');
+	for (auto const& target : targets)
+	{
+		for (auto const& marker : { "CMakeFiles/" + target + ".dir/", "/" + target + ".vcxproj", "/" + target + nexus_library_extension })
+		{
+			if (text.find(marker) != std::string::npos) return target;
+		}
+	}
+	return std::nullopt;
+}
+
+
+//============================================================================
+std::vector<std::string> nexus_run_build(NexusBuildPlan const& plan)
+{
+	std::vector<std::string> failed;
+	for (auto const& step : plan.configure)
+	{
+		auto command = nexus_build_command(plan, step);
+		qDebug() << command;
+		if (std::system(command.c_str()) == 0) continue;
+		for (auto const& build_step : plan.build) failed.insert(failed.end(), build_step.targets.begin(), build_step.targets.end());
+		return failed;
+	}
+
+	for (auto const& step : plan.build)
+	{
+		auto command = nexus_build_command(plan, step);
+		qDebug() << command;
+		if (std::system(command.c_str()) == 0) continue;
+
+		// the build kept going past the failure, the log tells which targets it was
+		std::set<std::string> blamed;
+		std::ifstream log(step.log_file);
+		std::string line;
+		while (std::getline(log, line))
+		{
+			auto target = nexus_failed_target(line, step.targets);
+			if (target.has_value()) blamed.insert(target.value());
+		}
+		if (blamed.empty()) blamed.insert(step.targets.begin(), step.targets.end());
+		for (auto const& target : blamed)
+		{
+			qDebug() << "Failed to build " << QString::fromStdString(target);
+			failed.push_back(target);
+		}
+	}
+	return failed;
+}
+
+
+//============================================================================
+std::optional<NexusBuildDiagnostic> nexus_parse_diagnostic(std::string_view line)
+{
+	// file(line[,column]): error C2065: message [project.vcxproj]
+	static const std::regex msvc(R"(^\s*(.+?)\((\d+)(?:,(\d+))?\)\s*:\s*(fatal error|error|warning)\s+(\w+)\s*:\s*(.*?)(?:\s+\[[^\]]+\])?\s*$)");
+	// object or LINK : fatal error LNK1104: message [project.vcxproj]
+	static const std::regex msvc_link(R"(^\s*(.+?)\s+:\s+(fatal error|error|warning)\s+(LNK\d+)\s*:\s*(.*?)(?:\s+\[[^\]]+\])?\s*$)");
+	// file:line:column: error: message
+	static const std::regex gcc(R"(^\s*(.+?):(\d+):(?:(\d+):)?\s*(fatal error|error|warning):\s*(.*?)\s*$)");
+
+	std::string text(line);
+	std::smatch match;
+	NexusBuildDiagnostic diagnostic;
+	if (std::regex_match(text, match, msvc)) {
+		diagnostic.file = match[1].str();
+		diagnostic.line = std::stoi(match[2].str());
+		diagnostic.column = match[3].matched ? std::stoi(match[3].str()) : 0;
+		diagnostic.is_error = match[4].str() != "warning";
+		diagnostic.code = match[5].str();
+		diagnostic.message = match[6].str();
+		return diagnostic;
+	}
+	if (std::regex_match(text, match, msvc_link)) {
+		diagnostic.file = match[1].str();
+		diagnostic.is_error = match[2].str() != "warning";
+		diagnostic.code = match[3].str();
+		diagnostic.message = match[4].str();
+		return diagnostic;
+	}
+	if (std::regex_match(text, match, gcc)) {
+		diagnostic.file = match[1].str();
+		diagnostic.line = std::stoi(match[2].str());
+		diagnostic.column = match[3].matched ? std::stoi(match[3].str()) : 0;
+		diagnostic.is_error = match[4].str() != "warning";
+		diagnostic.message = match[5].str();
+		return diagnostic;
+	}
+	return std::nullopt;
+}
+
+
+//============================================================================
+bool nexus_is_compile_line(std::string_view line)
+{
+	if (line.find("Building CXX object") != std::string_view::npos) return true;
+	if (line.find("Building C object") != std::string_view::npos) return true;
+
+	auto begin = line.find_first_not_of(" \t");
+	auto end = line.find_last_not_of(" \t\r");
+	if (begin == std::string_view::npos) return false;
+	auto name = line.substr(begin, end - begin + 1);
+	if (name.find_first_of(" :\\/") != std::string_view::npos) return false;
+	for (std::string_view extension : { ".cpp", ".cxx", ".cc", ".c" })
+	{
+		if (name.size() > extension.size() && name.ends_with(extension)) return true;
+	}
+	return false;
+}
+
+
+//============================================================================
+std::string nexus_pgo_summary(NexusPgoReport const& report)
+{
+	static const std::vector<std::string> names = { "Regular build", "Instrumented build", "Profile guided build" };
+	std::ostringstream summary;
+	summary << std::fixed << std::setprecision(2);
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		double ms = report.backtest_ms[i];
+		summary << names[i] << ": " << ms << " ms";
+		if (ms > 0.0) summary << ", " << static_cast<double>(report.candles) / (ms / 1000.0) << " candles per second";
+		summary << "\n";
+	}
+
+	// the instrumented run only collects the profile, its counters make it slower than either build
+	auto regular = report.backtest_ms[static_cast<size_t>(NexusPgoPhase::NONE)];
+	auto optimized = report.backtest_ms[static_cast<size_t>(NexusPgoPhase::USE)];
+	if (regular > 0.0 && optimized > 0.0) summary << "Speedup: " << regular / optimized << "x";
+	return summary.str();
+}
@@ -0,0 +1,268 @@
+#include "NexusBuildOutput.h"
+
+#include <algorithm>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+
+//============================================================================
+NexusBuildOutput::NexusBuildOutput(QWidget* parent) :
+	QWidget(parent)
+{
+	QVBoxLayout* l = new QVBoxLayout(this);
+
+	QHBoxLayout* status_layout = new QHBoxLayout();
+	this->status = new QLabel("No build", this);
+	this->progress = new QProgressBar(this);
+	this->progress->setRange(0, 1);
+	this->progress->setValue(0);
+	this->progress->setFixedWidth(200);
+	this->cancel_button = new QPushButton("Cancel", this);
+	this->cancel_button->setEnabled(false);
+	status_layout->addWidget(this->status, 1);
+	status_layout->addWidget(this->progress);
+	status_layout->addWidget(this->cancel_button);
+	l->addLayout(status_layout);
+
+	QSplitter* splitter = new QSplitter(Qt::Vertical, this);
+	this->diagnostics = new QTreeWidget(splitter);
+	this->diagnostics->setHeaderLabels({ "Strategy", "File", "Line", "Code", "Message" });
+	this->diagnostics->setRootIsDecorated(false);
+	this->diagnostics->header()->setSectionResizeMode(4, QHeaderView::Stretch);
+	this->output = new QPlainTextEdit(splitter);
+	this->output->setReadOnly(true);
+	this->output->setMaximumBlockCount(20000);
+	this->output->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+	splitter->addWidget(this->diagnostics);
+	splitter->addWidget(this->output);
+	l->addWidget(splitter);
+
+	connect(this->cancel_button, &QPushButton::clicked, this, &NexusBuildOutput::cancel);
+	connect(this->diagnostics, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem* item, int) {
+		emit this->diagnostic_activated(
+			item->data(1, Qt::UserRole).toString(),
+			item->data(2, Qt::UserRole).toInt(),
+			item->text(0)
+		);
+	});
+}
+
+
+//============================================================================
+NexusBuildOutput::~NexusBuildOutput()
+{
+	// don't leave compilers running after the window is gone
+	for (auto& [process, buffer] : this->pending_output)
+	{
+		process->disconnect(this);
+		process->kill();
+		process->waitForFinished(1000);
+	}
+}
+
+
+//============================================================================
+void NexusBuildOutput::set_source_strategy(std::function<std::optional<std::string>(fs::path const&)> source_strategy_)
+{
+	this->source_strategy = std::move(source_strategy_);
+}
+
+
+//============================================================================
+void NexusBuildOutput::start(NexusBuildPlan plan_)
+{
+	this->plan = std::move(plan_);
+	this->next_configure = 0;
+	this->next_build = 0;
+	this->compiled = 0;
+	this->errors = 0;
+	this->warnings = 0;
+	this->cancelled = false;
+	this->running = true;
+	this->failed.clear();
+	this->diagnostics->clear();
+	this->output->clear();
+	this->progress->setRange(0, static_cast<int>(std::max<size_t>(this->plan.translation_units, 1)));
+	this->progress->setValue(0);
+	this->cancel_button->setEnabled(true);
+	this->status->setText("Building...");
+	this->schedule();
+}
+
+
+//============================================================================
+void NexusBuildOutput::cancel()
+{
+	if (!this->running || this->cancelled) return;
+	this->cancelled = true;
+	this->status->setText("Cancelling...");
+	std::vector<QProcess*> processes;
+	for (auto& [process, buffer] : this->pending_output) processes.push_back(process);
+	for (auto process : processes) process->kill();
+	if (this->pending_output.empty()) this->finish();
+}
+
+
+//============================================================================
+void NexusBuildOutput::schedule()
+{
+	if (this->cancelled) {
+		if (this->pending_output.empty()) this->finish();
+		return;
+	}
+
+	// one step at a time, configure steps first. A build step parallelizes its targets itself.
+	if (!this->pending_output.empty()) return;
+	if (this->next_configure < this->plan.configure.size()) {
+		this->launch(this->plan.configure[this->next_configure++], true);
+	}
+	else if (this->next_build < this->plan.build.size()) {
+		this->launch(this->plan.build[this->next_build++], false);
+	}
+	else this->finish();
+}
+
+
+//============================================================================
+void NexusBuildOutput::launch(NexusBuildStep const& step, bool configure)
+{
+	this->step_targets = configure ? std::vector<std::string>{} : step.targets;
+	this->blamed.clear();
+
+	QStringList arguments;
+	for (auto const& argument : step.arguments) arguments << QString::fromStdString(argument);
+	this->add_line("> cmake " + arguments.join(' '));
+
+	QProcess* process = new QProcess(this);
+	this->pending_output[process] = QByteArray();
+	process->setWorkingDirectory(QString::fromStdString(this->plan.build_folder.string()));
+	process->setProcessChannelMode(QProcess::MergedChannels);
+	connect(process, &QProcess::readyReadStandardOutput, this, [this, process]() {
+		this->read_output(process, false);
+	});
+	connect(process, &QProcess::finished, this, [this, process, configure](int exit_code, QProcess::ExitStatus exit_status) {
+		this->read_output(process, true);
+		this->step_finished(process, configure, exit_status == QProcess::NormalExit && exit_code == 0);
+	});
+	connect(process, &QProcess::errorOccurred, this, [this, process, configure](QProcess::ProcessError error) {
+		// a process that never started doesn't emit finished
+		if (error != QProcess::FailedToStart) return;
+		this->add_line("Failed to start cmake: " + process->errorString());
+		this->step_finished(process, configure, false);
+	});
+	process->start("cmake", arguments);
+}
+
+
+//============================================================================
+void NexusBuildOutput::read_output(QProcess* process, bool flush)
+{
+	auto it = this->pending_output.find(process);
+	if (it == this->pending_output.end()) return;
+	auto& buffer = it->second;
+	buffer += process->readAllStandardOutput();
+
+	// output arrives in arbitrary chunks, only complete lines are parsed
+	qsizetype start = 0;
+	qsizetype end;
+	while ((end = buffer.indexOf('\n', start)) != -1)
+	{
+		this->add_line(QString::fromLocal8Bit(buffer.mid(start, end - start)).trimmed());
+		start = end + 1;
+	}
+	buffer.remove(0, start);
+	if (flush && !buffer.isEmpty()) {
+		this->add_line(QString::fromLocal8Bit(buffer).trimmed());
+		buffer.clear();
+	}
+}
+
+
+//============================================================================
+void NexusBuildOutput::add_line(QString const& line)
+{
+	if (line.isEmpty()) return;
+	this->output->appendPlainText(line);
+
+	auto text = line.toStdString();
+	if (nexus_is_compile_line(text)) {
+		this->compiled++;
+		this->progress->setValue(static_cast<int>(std::min<size_t>(this->compiled, this->progress->maximum())));
+		return;
+	}
+
+	// the build keeps going past a failed target, its failure lines tell which targets to report
+	auto failed_target = nexus_failed_target(text, this->step_targets);
+	if (failed_target.has_value()) this->blamed.insert(failed_target.value());
+
+	auto diagnostic = nexus_parse_diagnostic(text);
+	if (!diagnostic.has_value()) return;
+	if (diagnostic->is_error) this->errors++;
+	else this->warnings++;
+
+	std::string strategy_id;
+	if (this->source_strategy && diagnostic->line > 0) {
+		strategy_id = this->source_strategy(fs::path(diagnostic->file)).value_or("");
+	}
+	QTreeWidgetItem* item = new QTreeWidgetItem(this->diagnostics);
+	item->setText(0, QString::fromStdString(strategy_id));
+	item->setText(1, QString::fromStdString(fs::path(diagnostic->file).filename().string()));
+	item->setText(2, diagnostic->line > 0 ? QString::number(diagnostic->line) : QString());
+	item->setText(3, QString::fromStdString(diagnostic->code));
+	item->setText(4, QString::fromStdString(diagnostic->message));
+	item->setToolTip(1, QString::fromStdString(diagnostic->file));
+	item->setData(1, Qt::UserRole, QString::fromStdString(diagnostic->file));
+	item->setData(2, Qt::UserRole, diagnostic->line);
+	if (diagnostic->is_error) item->setForeground(4, QBrush(Qt::red));
+}
+
+
+//============================================================================
+void NexusBuildOutput::step_finished(QProcess* process, bool configure, bool success)
+{
+	if (this->pending_output.erase(process) == 0) return;
+	process->deleteLater();
+
+	if (!success && !this->cancelled) {
+		if (configure) {
+			// nothing can be built without the project, every target failed
+			for (size_t i = this->next_build; i < this->plan.build.size(); i++)
+			{
+				for (auto const& target : this->plan.build[i].targets) this->failed << QString::fromStdString(target);
+			}
+			this->next_configure = this->plan.configure.size();
+			this->next_build = this->plan.build.size();
+		}
+		else {
+			// a failure none of the lines could be traced to fails every target of the step
+			if (this->blamed.empty()) this->blamed.insert(this->step_targets.begin(), this->step_targets.end());
+			for (auto const& target : this->blamed) this->failed << QString::fromStdString(target);
+		}
+	}
+	this->schedule();
+}
+
+
+//============================================================================
+void NexusBuildOutput::finish()
+{
+	if (!this->running) return;
+	this->running = false;
+	this->cancel_button->setEnabled(false);
+
+	QString summary = QString::number(this->errors) + " error(s), " + QString::number(this->warnings) + " warning(s)";
+	if (this->cancelled) {
+		this->status->setText("Build cancelled, " + summary);
+	}
+	else if (!this->failed.isEmpty()) {
+		this->status->setText("Build failed (" + this->failed.join(", ") + "), " + summary);
+	}
+	else {
+		this->progress->setValue(this->progress->maximum());
+		this->status->setText("Build succeeded, " + summary);
+	}
+	emit this->build_finished(this->failed, this->cancelled);
+}
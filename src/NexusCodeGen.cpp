@@ -0,0 +1,61 @@
+#include "NexusCodeGen.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+
+//============================================================================
+uint64_t nexus_content_hash(std::string_view content) noexcept
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : content)
+	{
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+
+//============================================================================
+static std::string read_file(fs::path const& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) return std::string();
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+//============================================================================
+bool nexus_write_if_changed(fs::path const& path, std::string const& content)
+{
+	// a file of another size can't hold the same content, only one of the same size is read and compared
+	std::error_code ec;
+	auto size = fs::file_size(path, ec);
+	if (!ec && size == content.size() && read_file(path) == content) return false;
+	if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to write generated file: " + path.string());
+	}
+	file << content;
+	return true;
+}
+
+
+//============================================================================
+size_t nexus_sync_generated(fs::path const& staging, fs::path const& target)
+{
+	size_t written = 0;
+	if (!fs::exists(staging)) return written;
+	for (auto const& entry : fs::recursive_directory_iterator(staging))
+	{
+		if (!entry.is_regular_file()) continue;
+		auto relative = fs::relative(entry.path(), staging);
+		if (nexus_write_if_changed(target / relative, read_file(entry.path()))) written++;
+	}
+	fs::remove_all(staging);
+	return written;
+}
@@ -0,0 +1,161 @@
+#include "NexusCorrelation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
+
+
+//============================================================================
+Eigen::MatrixXd nexus_returns_matrix(std::vector<std::span<const double>> const& nlv_series)
+{
+	size_t length = 0;
+	for (auto const& nlv : nlv_series) length = std::max(length, nlv.size());
+	size_t rows = length > 1 ? length - 1 : 0;
+	Eigen::MatrixXd returns = Eigen::MatrixXd::Zero(rows, nlv_series.size());
+
+	// each column is written by exactly one task, no synchronization needed
+	std::vector<size_t> columns(nlv_series.size());
+	std::iota(columns.begin(), columns.end(), 0);
+	std::for_each(std::execution::par, columns.begin(), columns.end(), [&](size_t j) {
+		auto const& nlv = nlv_series[j];
+		size_t offset = length - nlv.size();
+		double* column = returns.col(j).data();
+		for (size_t i = 1; i < nlv.size(); i++)
+		{
+			double prev = nlv[i - 1];
+			if (prev == 0.0 || std::isnan(prev) || std::isnan(nlv[i])) continue;
+			column[offset + i - 1] = (nlv[i] - prev) / prev;
+		}
+	});
+	return returns;
+}
+
+
+//============================================================================
+Eigen::MatrixXd nexus_correlation_matrix(Eigen::MatrixXd const& returns, size_t tile)
+{
+	Eigen::Index n = returns.cols();
+	Eigen::MatrixXd correlation(n, n);
+	if (n == 0) return correlation;
+	tile = std::max<size_t>(1, tile);
+
+	// standardize each column to zero mean and unit norm so the correlation is a plain inner product
+	Eigen::MatrixXd z = returns;
+	std::vector<char> degenerate(n, 0);
+	std::vector<Eigen::Index> columns(n);
+	std::iota(columns.begin(), columns.end(), 0);
+	std::for_each(std::execution::par, columns.begin(), columns.end(), [&](Eigen::Index j) {
+		auto column = z.col(j);
+		column.array() -= column.mean();
+		double norm = column.norm();
+		if (norm > 0.0) column /= norm;
+		else degenerate[j] = 1;
+	});
+
+	// enumerate the upper triangle of tile pairs, every pair writes a disjoint block of the output
+	Eigen::Index t = static_cast<Eigen::Index>(tile);
+	Eigen::Index tiles = (n + t - 1) / t;
+	std::vector<std::pair<Eigen::Index, Eigen::Index>> tile_pairs;
+	tile_pairs.reserve(tiles * (tiles + 1) / 2);
+	for (Eigen::Index bi = 0; bi < tiles; bi++)
+	{
+		for (Eigen::Index bj = bi; bj < tiles; bj++) tile_pairs.emplace_back(bi, bj);
+	}
+	std::for_each(std::execution::par, tile_pairs.begin(), tile_pairs.end(), [&](auto const& tile_pair) {
+		Eigen::Index i0 = tile_pair.first * t;
+		Eigen::Index j0 = tile_pair.second * t;
+		Eigen::Index ni = std::min(t, n - i0);
+		Eigen::Index nj = std::min(t, n - j0);
+		correlation.block(i0, j0, ni, nj).noalias() = z.middleCols(i0, ni).transpose() * z.middleCols(j0, nj);
+	});
+
+	// mirror the upper triangle and clean up the diagonal and constant series
+	for (Eigen::Index j = 0; j < n; j++)
+	{
+		for (Eigen::Index i = j + 1; i < n; i++) correlation(i, j) = correlation(j, i);
+	}
+	for (Eigen::Index j = 0; j < n; j++)
+	{
+		if (degenerate[j]) {
+			correlation.row(j).setConstant(std::numeric_limits<double>::quiet_NaN());
+			correlation.col(j).setConstant(std::numeric_limits<double>::quiet_NaN());
+		}
+		else {
+			correlation(j, j) = 1.0;
+		}
+	}
+	return correlation;
+}
+
+
+//============================================================================
+std::vector<size_t> nexus_cluster_order(Eigen::MatrixXd const& correlation)
+{
+	size_t n = static_cast<size_t>(correlation.rows());
+	if (n == 0) return {};
+
+	// correlation distance, series with no defined correlation are placed furthest away
+	Eigen::MatrixXd distance(n, n);
+	for (size_t j = 0; j < n; j++)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			double rho = correlation(i, j);
+			distance(i, j) = std::isnan(rho) ? 1.0 : std::sqrt(std::max(0.0, 0.5 * (1.0 - rho)));
+		}
+	}
+
+	std::vector<std::vector<size_t>> leaves(n);
+	for (size_t i = 0; i < n; i++) leaves[i] = { i };
+	std::vector<size_t> sizes(n, 1);
+	std::vector<char> active(n, 1);
+	std::vector<size_t> chain;
+	chain.reserve(n);
+	size_t remaining = n;
+
+	while (remaining > 1)
+	{
+		if (chain.empty()) {
+			chain.push_back(std::distance(active.begin(), std::find(active.begin(), active.end(), 1)));
+		}
+
+		// find the nearest active neighbour of the chain tip, preferring the previous link on ties
+		size_t a = chain.back();
+		size_t prev = chain.size() > 1 ? chain[chain.size() - 2] : n;
+		size_t b = prev;
+		double best = prev < n ? distance(a, prev) : std::numeric_limits<double>::infinity();
+		for (size_t k = 0; k < n; k++)
+		{
+			if (!active[k] || k == a) continue;
+			if (distance(a, k) < best) {
+				best = distance(a, k);
+				b = k;
+			}
+		}
+		if (b != prev) {
+			chain.push_back(b);
+			continue;
+		}
+
+		// a and b are reciprocal nearest neighbours, merge b into a with the lance williams update
+		chain.pop_back();
+		chain.pop_back();
+		double wa = static_cast<double>(sizes[a]);
+		double wb = static_cast<double>(sizes[b]);
+		for (size_t k = 0; k < n; k++)
+		{
+			if (!active[k] || k == a || k == b) continue;
+			double d = (wa * distance(a, k) + wb * distance(b, k)) / (wa + wb);
+			distance(a, k) = d;
+			distance(k, a) = d;
+		}
+		sizes[a] += sizes[b];
+		leaves[a].insert(leaves[a].end(), leaves[b].begin(), leaves[b].end());
+		leaves[b].clear();
+		active[b] = 0;
+		remaining--;
+	}
+	return leaves[std::distance(active.begin(), std::find(active.begin(), active.end(), 1))];
+}
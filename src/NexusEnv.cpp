@@ -1,9 +1,22 @@
 #include "NexusPch.h"
+#include <chrono>
 #include <fstream>
 #include <cstdlib>
+#include <execution>
+#include <map>
+#include <numeric>
+#include <set>
+#include <thread>
 #include "NexusEnv.h"
 #include "NexusNode.h"
 #include "NexusNodeModel.h"
+#include "NexusFlowCompiler.h"
+#include "NexusCodeGen.h"
+#include "NexusBuild.h"
+#include "NexusNativeKernel.h"
+#include "NexusSnapshot.h"
+#include "NexusAvailability.h"
+#include "NexusFeatureCache.h"
 #include <AgisStrategyRegistry.h>
 #include "Broker/Broker.Base.h"
 
@@ -17,6 +30,34 @@ std::string build_method = "debug";
 std::string build_method = "release";
 #endif
 
+
+//============================================================================
+static size_t count_sources(fs::path const& folder)
+{
+	size_t count = 0;
+	if (!fs::exists(folder)) return count;
+	for (auto const& entry : fs::recursive_directory_iterator(folder))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".cpp") count++;
+	}
+	return count;
+}
+
+
+//============================================================================
+static std::string cached_pgo_phase(fs::path const& build_folder)
+{
+	// the phase the build folder was last configured for, a different one needs a reconfigure
+	std::ifstream cache(build_folder / "CMakeCache.txt");
+	std::string line;
+	while (std::getline(cache, line))
+	{
+		if (line.starts_with("NEXUS_PGO:")) return line.substr(line.find('=') + 1);
+	}
+	return nexus_pgo_strings[static_cast<size_t>(NexusPgoPhase::NONE)];
+}
+
+
 #include "Portfolio.h"
 #include "Asset/Asset.h"
 
@@ -73,10 +114,11 @@ NexusEnv::NexusEnv() : hydra(Hydra())
 //============================================================================
 NexusEnv::~NexusEnv()
 {
-	if (this->agis_strategy_dll_loaded)
-	{
-		FreeLibrary(this->AgisStrategyDLL);
-	}
+	// strategies are destroyed while the libraries that contain their code are still loaded
+	this->hydra.clear();
+	NexusNativeKernels::instance().clear();
+	this->strategy_owners.clear();
+	this->strategy_libraries.clear();
 }
 
 
@@ -247,7 +289,7 @@ AgisResult<bool> NexusEnv::new_exchange(
 )
 {
 	qDebug() << "Building new exchange: " << exchange_id;
-	return this->hydra.new_exchange(
+	auto res = this->hydra.new_exchange(
 		AssetType::US_EQUITY, // TODO fix this
 		exchange_id,
 		source,
@@ -256,6 +298,39 @@ AgisResult<bool> NexusEnv::new_exchange(
 		std::nullopt,
 		market_asset
 		);
+	if (res.is_exception()) return res;
+
+	this->__cache_exchange(exchange_id);
+	return res;
+}
+
+
+//============================================================================
+std::expected<bool, AgisException> NexusEnv::restore_exchanges(rapidjson::Document const& j)
+{
+	AGIS_ASSIGN_OR_RETURN(res, this->hydra.restore_exchanges(j));
+	this->exchange_caches.clear();
+	for (auto const& exchange_id : this->hydra.get_exchanges().get_exchange_ids())
+	{
+		this->__cache_exchange(exchange_id);
+	}
+	return res;
+}
+
+
+//============================================================================
+void NexusEnv::__cache_exchange(std::string const& exchange_id)
+{
+	auto exchange_opt = this->hydra.get_exchange(exchange_id);
+	if (!exchange_opt.has_value()) return;
+	this->exchange_caches.schedule(exchange_id, exchange_opt.value(), this->env_path / "cache" / (exchange_id + ".nxc"));
+}
+
+
+//============================================================================
+std::shared_ptr<NexusExchangeCache const> NexusEnv::get_asset_cache(std::string const& asset_id) const
+{
+	return this->exchange_caches.get(asset_id);
 }
 
 
@@ -354,6 +429,7 @@ NexusStatusCode NexusEnv::new_strategy(
 NexusStatusCode NexusEnv::remove_exchange(const std::string& name)
 {
 	qDebug() << "Removing exchange: " << name;
+	this->exchange_caches.remove(name);
 	return this->hydra.remove_exchange(name);
 }
 
@@ -371,6 +447,7 @@ NexusStatusCode NexusEnv::remove_strategy(const std::string& name)
 {
 	if (!this->hydra.strategy_exists(name)) return NexusStatusCode::InvalidArgument;
 	this->hydra.remove_strategy(name);
+	this->strategy_owners.erase(name);
 	return NexusStatusCode::Ok;
 }
 
@@ -430,32 +507,105 @@ void NexusEnv::__save_history()
 
 
 //============================================================================
-void NexusEnv::__compile()
+NexusBuildPlan NexusEnv::__prepare_compile(NexusPgoPhase phase)
 {
 	qDebug() << "============================================================================";
 	qDebug() << "Compiling strategies...";
+	// a debug Nexus can only load debug strategy libraries, profiling those says nothing about the release build
+	if (phase != NexusPgoPhase::NONE && build_method != "release") {
+		AGIS_THROW("Profile guided builds need a release build of Nexus");
+	}
 	auto strat_folder = this->env_path / "strategies";
 	auto& strategies = this->hydra.__get_strategy_map().__get_strategies();
 
+	// the strategies are about to be replaced, the next run probes the history of every asset again
+	NexusAvailability::instance().clear();
+
 	// generate code for all abstract strategies
+	std::set<std::string> abstract_only;
+	std::set<std::string> native_only;
+	std::map<std::string, std::string> native_sources;
+	auto hydra_ptr = this->get_hydra();
 	for (auto& strategy_pair : strategies)
 	{
 		auto& strategy = strategy_pair.second;
-		auto strat_path = strat_folder / strategy->get_strategy_id();
+		auto strategy_id = strategy->get_strategy_id();
+		auto strat_path = strat_folder / strategy_id;
 		if (!strategy->__is_abstract_class()) { continue; }
 
+		std::optional<QJsonObject> flow = std::nullopt;
+		try {
+			flow = nexus_read_flow(strat_path / "graph.flow");
+		}
+		catch (std::exception&) {
+			// no saved graph, nothing to check
+		}
+
+		// the asset lambda chain and exchange view are specialized into a native kernel the abstract strategy
+		// runs, everything after the view stays in Nexus so graphs with transforms and optimizers qualify too
+		if (flow.has_value()) {
+			std::optional<NexusFlowKernel> flow_kernel = std::nullopt;
+			try {
+				flow_kernel = nexus_flow_kernel(flow.value(), hydra_ptr);
+			}
+			catch (std::exception&) {
+				// invalid graph, the code gen below reports it
+			}
+			if (flow_kernel.has_value() && nexus_native_supported(flow_kernel->kernel)) {
+				// the abstract strategy is disabled while its class is linked, a linked <id>_CPP keeps the kernel in the build
+				native_only.insert(strategy_id);
+				if (strategy->__is_live() || this->hydra.strategy_exists(strategy_id + "_CPP")) {
+					qDebug() << "Generating native kernel for " << QString::fromStdString(strategy_id);
+					native_sources[strategy_id] = nexus_native_codegen(
+						flow_kernel->kernel,
+						strategy_id,
+						flow_kernel->query_type,
+						flow_kernel->N
+					);
+				}
+				// the strategy class generated by an earlier compile must not be built next to the kernel
+				std::error_code ec;
+				fs::remove(strat_path / (strategy_id + "_CPP.h"), ec);
+				fs::remove(strat_path / (strategy_id + "_CPP.cpp"), ec);
+				continue;
+			}
+		}
+
+		// rolling windows and view transforms can't be expressed in the generated code, keep running those strategies abstract
+		if (flow.has_value() && nexus_flow_requires_abstract(flow.value())) {
+			qDebug() << "Skipping code gen for " << QString::fromStdString(strategy_id) << ", it uses nodes without code gen support";
+			abstract_only.insert(strategy_id);
+			continue;
+		}
+
+		// generate into a staging folder and only copy over files whose content changed so the
+		// timestamps of unchanged strategies survive and their translation units are not rebuilt
 		auto* abstract_strategy = dynamic_cast<AbstractAgisStrategy*>(strategy.get());
-		AGIS_TRY(abstract_strategy->code_gen(strat_path);)
+		auto staging_path = this->env_path / "build" / "codegen" / strategy->get_strategy_id();
+		fs::remove_all(staging_path);
+		fs::create_directories(staging_path);
+		AGIS_TRY(abstract_strategy->code_gen(staging_path);)
+		AGIS_TRY(
+			auto written = nexus_sync_generated(staging_path, strat_path);
+			if (written) qDebug() << "Generated " << written << " changed file(s) for " << QString::fromStdString(strategy->get_strategy_id());
+		)
 	}
 
-	// include strategy classes
-	std::string strategy_include = R"()";
-	std::string strategy_create = R"(
+	// every strategy is registered from its own translation unit, changing one strategy only rebuilds its unit
+	std::string strategy_register = R"(// generated by Nexus to register {STRAT} with the static strategy register.
+// ANY CHANGES WILL BE OVERWRITEN ON THE NEXT COMPILE
+#include "pch.h"
+{INCLUDE}
+
+static bool registered_{STRAT} = StrategyRegistry::registerStrategy("{STRAT}",
     [](PortfolioPtr const& p) {
         return std::make_unique<{STRAT}>(p);
     }
+, "{PORTFOLIO}");
 )";
-	// add include paths for pch.h
+	auto registry_folder = this->env_path / "registry";
+	std::set<fs::path> registry_files;
+	std::vector<std::pair<std::string, std::string>> strategy_units;
 	for (auto& strategy_pair : strategies)
 	{
 		// skip non-live strategies
@@ -463,6 +613,7 @@ void NexusEnv::__compile()
 		auto t = strategy_pair.second->get_strategy_type();
 		if (t == AgisStrategyType::BENCHMARK) continue;
 		if (t == AgisStrategyType::LUAJIT) continue;
+		if (abstract_only.contains(strategy_pair.second->get_strategy_id())) continue;
 		bool is_abstract = strategy_pair.second->__is_abstract_class();
 
 		auto strategy_id = strategy_pair.second->get_strategy_id();
@@ -472,23 +623,42 @@ void NexusEnv::__compile()
 		{
 			strategy_id = strategy_id.substr(0, strategy_id.size() - 4);
 		}
-		std::string strat_include_mid = "#include \"strategies/" + strategy_id + "/"
+		// native kernels get their own unit below
+		if (native_only.contains(strategy_id)) continue;
+		std::string strat_include = "#include \"strategies/" + strategy_id + "/"
 			+ strategy_pair.second->get_strategy_id();
-		if (is_abstract) strat_include_mid += +"_CPP.h\"\n";
-		else strat_include_mid += +".h\"\n";
-		
-		// register the strategy to the registry
-		strat_include_mid += "static bool registered_{STRAT} = StrategyRegistry::registerStrategy(\"{STRAT}\"," + \
-			strategy_create + ", \"{PORTFOLIO}\");\n";
+		if (is_abstract) strat_include += +"_CPP.h\"";
+		else strat_include += +".h\"";
+
 		std::string strategy_class = strategy_pair.second->get_strategy_id();
 		if (is_abstract) strategy_class += "_CPP";
-		str_replace_all(strat_include_mid, "{STRAT}", strategy_class);
+		std::string strat_register = strategy_register;
+		str_replace_all(strat_register, "{INCLUDE}", strat_include);
+		str_replace_all(strat_register, "{STRAT}", strategy_class);
+		str_replace_all(strat_register, "{PORTFOLIO}", strategy_pair.second->get_portfolio_id());
+
+		auto registry_file = registry_folder / (strategy_class + ".cpp");
+		registry_files.insert(registry_file);
+		strategy_units.emplace_back(strategy_class, strategy_id);
+		AGIS_TRY(nexus_write_if_changed(registry_file, strat_register);)
+	}
 
-		// Set the static portfolio id
-		auto pos = strat_include_mid.find("{PORTFOLIO}");
-		strat_include_mid.replace(pos, 11, strategy_pair.second->get_portfolio_id());
+	// a native kernel takes the unit of the strategy class
+	for (auto const& [strategy_id, native_source] : native_sources)
+	{
+		std::string strategy_class = strategy_id + "_CPP";
+		auto registry_file = registry_folder / (strategy_class + ".cpp");
+		registry_files.insert(registry_file);
+		strategy_units.emplace_back(strategy_class, strategy_id);
+		AGIS_TRY(nexus_write_if_changed(registry_file, native_source);)
+	}
 
-		strategy_include += strat_include_mid;
+	// strategies that were removed or are no longer live must not stay in the build
+	if (fs::exists(registry_folder)) {
+		for (auto const& entry : fs::directory_iterator(registry_folder))
+		{
+			if (entry.is_regular_file() && !registry_files.contains(entry.path())) fs::remove(entry.path());
+		}
 	}
 
 	std::string pch_header = R"(// the following code is generated in order build the static strategy register from realized abstract strategies.
@@ -499,20 +669,27 @@ void NexusEnv::__compile()
 
 #ifndef PCH_H
 #define PCH_H
+#ifdef _WIN32
 #define NOMINMAX 
 #ifdef AGISSTRATEGY_EXPORTS // This should be defined when building the DLL
 #  define AGIS_STRATEGY_API __declspec(dllexport)
 #else
 #  define AGIS_STRATEGY_API __declspec(dllimport)
 #endif
-
 #include "framework.h"
+#else
+// the library is built with hidden visibility, only the registry wrappers are exported
+#  define AGIS_STRATEGY_API __attribute__((visibility("default")))
+#endif
+
 #include "json.hpp"
 using json = nlohmann::json;
 
 #include "AgisStrategyRegistry.h"
 
-{STRATEGY}
+#endif //PCH_H
+)";
+	std::string dll_main = R"(#include "pch.h"
 
 
 // Wrapper function to return the RegistryMap
@@ -526,13 +703,8 @@ extern "C" AGIS_STRATEGY_API StrategyRegistry::PortfolioIdMap& getIDRegistryWrap
     return StrategyRegistry::getIDMap();
 };
 
-#endif //PCH_H
-)";
-	auto pos = pch_header.find("{STRATEGY}");
-	pch_header.replace(pos, 10, strategy_include);
-	std::string dll_main = R"(#include "pch.h"
-
 
+#ifdef _WIN32
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserved) {
     switch (ul_reason_for_call) {
     case DLL_PROCESS_ATTACH:
@@ -541,9 +713,11 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
 
     return TRUE;
 }
+#endif
 )";
-	AGIS_TRY(code_gen_write(this->env_path / "dllmain.cpp", dll_main);)
-	AGIS_TRY(code_gen_write(this->env_path / "pch.h", pch_header);)
+	AGIS_TRY(nexus_write_if_changed(this->env_path / "dllmain.cpp", dll_main);)
+	AGIS_TRY(nexus_write_if_changed(this->env_path / "pch.h", pch_header);)
+	AGIS_TRY(nexus_write_if_changed(this->env_path / "nexus_kernel.h", nexus_native_header);)
 
 	// create build folder
 	auto build_folder = this->env_path / "build";
@@ -553,6 +727,62 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
 		fs::create_directories(build_folder);
 	}
 
+	NexusBuildPlan plan;
+	plan.build_folder = build_folder;
+	plan.per_strategy_libs = this->per_strategy_libs;
+
+	// profiles of an earlier profiling run must not be mixed into the one the instrumented build collects
+	auto pgo_folder = build_folder / "pgo";
+	if (phase == NexusPgoPhase::GENERATE && fs::exists(pgo_folder)) {
+		for (auto const& entry : fs::recursive_directory_iterator(pgo_folder))
+		{
+			auto extension = entry.path().extension();
+			if (extension != ".pgc" && extension != ".gcda" && extension != ".profraw" && extension != ".profdata") continue;
+			std::error_code ec;
+			fs::remove(entry.path(), ec);
+		}
+	}
+
+	// multi configuration generators pick the configuration at build time, the others need it when configuring
+	bool configured = fs::exists(build_folder / "CMakeCache.txt");
+	auto generator = this->agis_build_method;
+	if (generator.size() >= 2 && generator.front() == '"' && generator.back() == '"') {
+		generator = generator.substr(1, generator.size() - 2);
+	}
+	std::vector<std::string> configure_arguments;
+	if (!configured) {
+		configure_arguments = { "-G", generator };
+#ifndef _WIN32
+		configure_arguments.push_back("-DCMAKE_BUILD_TYPE=" + build_method);
+#endif
+	}
+	configure_arguments.push_back("-DNEXUS_PGO=" + nexus_pgo_strings[static_cast<size_t>(phase)]);
+	configure_arguments.push_back("..");
+
+	// every strategy in its own library, built in parallel and linked independently
+	if (this->per_strategy_libs) {
+		this->__write_strategy_libs_cmake(strategy_units);
+		if (!configured || cached_pgo_phase(build_folder) != nexus_pgo_strings[static_cast<size_t>(phase)]) {
+			plan.configure.push_back({ {}, configure_arguments, {} });
+		}
+
+		// one cmake process builds every library so the project is checked for regeneration once and the jobs
+		// are shared by all compilers. It keeps going past a failed library, the log names the ones that failed.
+		auto libs_folder = build_folder / "strategy_libs";
+		fs::create_directories(libs_folder);
+		NexusBuildStep step;
+		for (auto const& [strategy_class, strategy_folder] : strategy_units)
+		{
+			step.targets.push_back(strategy_class);
+			plan.translation_units += 2 + count_sources(strat_folder / strategy_folder);
+		}
+		size_t jobs = this->build_jobs ? this->build_jobs : std::max(1u, std::thread::hardware_concurrency());
+		step.arguments = nexus_parallel_build_arguments(generator, build_method, jobs);
+		step.log_file = libs_folder / "build.log";
+		if (!step.targets.empty()) plan.build.push_back(std::move(step));
+		return plan;
+	}
+
 	// CMake file contents
 	// cmake -G "Visual Studio 17 2022" ..
 	std::string cmake_content = R"(
@@ -571,16 +801,19 @@ include_directories("C:/dev/vcpkg/installed/x64-windows/include")
 
 # Set the path to the AgisCore lib
 set(AGIS_CORE_PATH "{AGIS_CORE_PATH}")
+{PGO_CMAKE}
 
 # Set the path to the adjacent folder
 set(ADJACENT_FOLDER "${CMAKE_CURRENT_SOURCE_DIR}/strategies")
 
-# Gather source files from the 'adjacent_folder' and its subdirectories
-file(GLOB_RECURSE SOURCE_FILES "${ADJACENT_FOLDER}/*.cpp")
+# Gather source files from the 'adjacent_folder' and its subdirectories, plus one registry unit per strategy
+file(GLOB_RECURSE SOURCE_FILES CONFIGURE_DEPENDS "${ADJACENT_FOLDER}/*.cpp")
+file(GLOB REGISTRY_FILES CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/registry/*.cpp")
+list(APPEND SOURCE_FILES ${REGISTRY_FILES})
 list(APPEND SOURCE_FILES "${CMAKE_CURRENT_SOURCE_DIR}/dllmain.cpp")
 
 # Gather header files from the 'adjacent_folder' and its subdirectories
-file(GLOB_RECURSE HEADER_FILES "${ADJACENT_FOLDER}/*.h")
+file(GLOB_RECURSE HEADER_FILES CONFIGURE_DEPENDS "${ADJACENT_FOLDER}/*.h")
 list(APPEND HEADER_FILES "${CMAKE_CURRENT_SOURCE_DIR}/pch.h")
 
 # Create the shared library (DLL)
@@ -588,6 +821,10 @@ add_library(AgisStrategy SHARED ${SOURCE_FILES} ${HEADER_FILES})
 
 target_compile_definitions(AgisStrategy PRIVATE AGISSTRATEGY_EXPORTS)
 
+# pch.h no longer lists the strategies, precompile it once and share it between the strategy units
+target_include_directories(AgisStrategy PRIVATE "${CMAKE_CURRENT_SOURCE_DIR}")
+target_precompile_headers(AgisStrategy PRIVATE "${CMAKE_CURRENT_SOURCE_DIR}/pch.h")
+
 # Include AgisCore header files 
 target_include_directories(AgisStrategy PUBLIC
     "{AGIS_CORE_INCLUDE}"
@@ -600,19 +837,22 @@ target_include_directories(AgisStrategy PUBLIC
 if (WIN32)
     # Export symbols to create a .def file (needed for Windows)
     target_compile_definitions(AgisStrategy PRIVATE MYDLL_EXPORTS)
-	
-	# Link the AgisCore DLL to the strategy DLL (use .lib for MSVC)
-	if (MSVC)
-		target_link_libraries(AgisStrategy PRIVATE "${AGIS_CORE_PATH}")
-	else ()
-		message(FATAL_ERROR "AgisStrategy can only be built with MSVC")
-	endif()
-
-else ()
-    # Throw an error if the target platform is not Windows (WIN32)
-    message(FATAL_ERROR "AgisStrategy requires a Windows (WIN32) platform.")
 endif()
 
+# Link AgisCore to the strategy library (the .lib for MSVC, the shared library for GCC or Clang)
+target_link_libraries(AgisStrategy PRIVATE "${AGIS_CORE_PATH}")
+
+# Position independent with only the registry wrappers exported, the same as a dll. Single
+# configuration generators put the library in a folder named after the build type like MSVC does.
+set_target_properties(AgisStrategy PROPERTIES
+    POSITION_INDEPENDENT_CODE ON
+    CXX_VISIBILITY_PRESET hidden
+    VISIBILITY_INLINES_HIDDEN ON
+    PREFIX ""
+    LIBRARY_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/$<CONFIG>"
+)
+nexus_pgo_target(AgisStrategy)
+
 # Installation to the build directory
 install(TARGETS AgisStrategy
     LIBRARY DESTINATION ${CMAKE_BINARY_DIR}/lib
@@ -623,93 +863,349 @@ install(TARGETS AgisStrategy
 )";
 
 	// Replace the placeholder with the BUILD_METHOD
-	pos = cmake_content.find("{AGIS_CORE_PATH}");
+	auto pos = cmake_content.find("{AGIS_CORE_PATH}");
 	cmake_content.replace(pos, 16, this->agis_lib_path);
 
 	// Replace the adis include path
 	str_replace_all(cmake_content, "{AGIS_CORE_INCLUDE}", this->agis_include_path);
+	str_replace_all(cmake_content, "{PGO_CMAKE}", nexus_pgo_cmake);
 
 
-	// create cmake file
+	// create cmake file, left untouched if unchanged so the build doesn't reconfigure
 	auto cmake_file = this->env_path / "CmakeLists.txt";
+	AGIS_TRY(nexus_write_if_changed(cmake_file, cmake_content);)
 
-	std::ofstream file(cmake_file);
-	if (file.is_open()) {
-		file << cmake_content;
-		file.close();
+	// once configured, cmake --build reruns the configure step itself when the CMake file or the set of globbed sources
+	// changes. Switching the profile guided phase changes the cache and has to be configured here.
+	if (!configured || cached_pgo_phase(build_folder) != nexus_pgo_strings[static_cast<size_t>(phase)]) {
+		plan.configure.push_back({ {}, configure_arguments, {} });
 	}
-	else {
-		AGIS_THROW("Failed to generate CMake file");
+	plan.build.push_back({ { "AgisStrategy" }, { "--build", ".", "--config", build_method }, {} });
+	plan.translation_units = registry_files.size() + 1 + count_sources(strat_folder);
+	return plan;
+}
+
+
+//============================================================================
+void NexusEnv::__compile()
+{
+	auto plan = this->__prepare_compile();
+	qDebug() << "==== Building strategies ====";
+	auto failed = nexus_run_build(plan);
+	qDebug() << "========================";
+	this->__finish_compile(plan, failed);
+}
+
+
+//============================================================================
+NexusPgoReport NexusEnv::__compile_pgo()
+{
+	NexusPgoReport report;
+	for (auto phase : { NexusPgoPhase::NONE, NexusPgoPhase::GENERATE, NexusPgoPhase::USE })
+	{
+		auto plan = this->__prepare_compile(phase);
+		qDebug() << "==== Building strategies (" << QString::fromStdString(nexus_pgo_strings[static_cast<size_t>(phase)]) << ") ====";
+		auto failed = nexus_run_build(plan);
+		this->__finish_compile(plan, failed);
+		report.backtest_ms[static_cast<size_t>(phase)] = this->__run_pgo_phase(phase);
 	}
+	report.candles = this->get_candle_count();
+	qDebug() << QString::fromStdString(nexus_pgo_summary(report));
+	return report;
+}
+
 
-	// if agis_strategy_dll_loaded is true, unload the dll
-	if (this->agis_strategy_dll_loaded) {
-		FreeLibrary(this->AgisStrategyDLL);
+//============================================================================
+double NexusEnv::__run_pgo_phase(NexusPgoPhase phase)
+{
+	// instrumented MSVC libraries import the profiling runtime the CMake project copied next to the profiles
+	if (phase == NexusPgoPhase::GENERATE) nexus_library_set_directory(this->env_path / "build" / "pgo");
+	try {
+		this->__link();
 	}
+	catch (...) {
+		nexus_library_set_directory({});
+		throw;
+	}
+	nexus_library_set_directory({});
 
-	// generate cmake build files
-	// Define the specific folder where you want to build the CMake files
-	std::string build_folder_str = build_folder.string();
-	std::replace(build_folder_str.begin(), build_folder_str.end(), '\\', '/');
-	auto cd_command = "cd " + build_folder_str;
+	qDebug() << "Running profile guided build backtest (" << QString::fromStdString(nexus_pgo_strings[static_cast<size_t>(phase)]) << ")";
+	auto start = std::chrono::high_resolution_clock::now();
+	auto res = this->__run();
+	auto end = std::chrono::high_resolution_clock::now();
 
-	// Concatenate the commands using the && operator
-	std::string full_command = cd_command + " && \
-		cmake -G " + this->agis_build_method + " .. && \
-		cmake --build . --config " + build_method;
+	// the profile is written when the instrumented libraries are freed, the optimized build can't be linked over them
+	if (phase == NexusPgoPhase::GENERATE) this->__unload_libraries();
+	if (res.is_exception()) AGIS_THROW(res.get_exception());
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
 
-	qDebug() << "==== Building AgisStrategy CMake ====";
-	qDebug() << full_command;
 
-	int result = std::system(full_command.c_str());
+//============================================================================
+void NexusEnv::__unload_libraries()
+{
+	for (auto const& [strategy_id, library] : this->strategy_owners)
+	{
+		if (this->hydra.strategy_exists(strategy_id)) this->hydra.remove_strategy(strategy_id);
+	}
+	NexusNativeKernels::instance().clear();
+	this->strategy_owners.clear();
+	this->strategy_libraries.clear();
+}
+
 
-	if (result != 0) {
-		AGIS_THROW("Failed to generate CMake build files or build AgisStrategy dll");
+//============================================================================
+void NexusEnv::__finish_compile(NexusBuildPlan const& plan, std::vector<std::string> const& failed)
+{
+	if (plan.per_strategy_libs) {
+		// a failed strategy must not be linked from an old build, neither may strategies that were removed
+		std::set<std::string> built;
+		for (auto const& step : plan.build) built.insert(step.targets.begin(), step.targets.end());
+		for (auto const& strategy_class : failed) built.erase(strategy_class);
+		auto output_dir = plan.build_folder / "strategy_libs" / build_method;
+		if (fs::exists(output_dir)) {
+			for (auto const& entry : fs::directory_iterator(output_dir))
+			{
+				if (!entry.is_regular_file() || built.contains(entry.path().stem().string())) continue;
+				std::error_code ec;
+				fs::remove(entry.path(), ec);
+			}
+		}
 	}
-	qDebug() << "========================";
 
+	if (!failed.empty()) {
+		if (!plan.per_strategy_libs) AGIS_THROW("Failed to generate CMake build files or build AgisStrategy dll");
+		auto sorted = failed;
+		std::sort(sorted.begin(), sorted.end());
+		std::string msg = "Failed to build strategy libraries:";
+		for (auto const& strategy_class : sorted) msg += " " + strategy_class;
+		AGIS_THROW(msg + ". The other strategies were built and can be linked");
+	}
 	qDebug() << "Compiling strategies complete";
 	qDebug() << "============================================================================";
 }
 
 
 //============================================================================
-LPCWSTR StringToLPCWSTR(const std::string& str) {
-	// Calculate the required buffer size for the wide character string
-	int bufferSize = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, NULL, 0);
+void NexusEnv::__write_strategy_libs_cmake(std::vector<std::pair<std::string, std::string>> const& strategy_units)
+{
+	// one shared library per strategy made of its registry unit, the dll entry point and the strategy's own sources
+	std::string cmake_content = R"(
+cmake_minimum_required(VERSION 3.26)
+
+# Enable C++20
+set(CMAKE_CXX_STANDARD 20)
+set(CMAKE_CXX_STANDARD_REQUIRED ON)
+set(CMAKE_CXX_EXTENSIONS OFF)
+
+project(AgisStrategies)
+
+# Include the Vcpkg toolchain file
+set(VCPKG_TOOLCHAIN_FILE "C:/dev/vcpkg/scripts/buildsystems/vcpkg.cmake" CACHE STRING "")
+include_directories("C:/dev/vcpkg/installed/x64-windows/include")
 
-	// Allocate memory for the wide character string
-	wchar_t* wideCharString = new wchar_t[bufferSize];
+# Set the path to the AgisCore lib
+set(AGIS_CORE_PATH "{AGIS_CORE_PATH}")
+{PGO_CMAKE}
+
+function(add_strategy_library STRATEGY_CLASS STRATEGY_FOLDER)
+    file(GLOB_RECURSE STRATEGY_SOURCES CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/strategies/${STRATEGY_FOLDER}/*.cpp")
+    add_library(${STRATEGY_CLASS} SHARED
+        "${CMAKE_CURRENT_SOURCE_DIR}/registry/${STRATEGY_CLASS}.cpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/dllmain.cpp"
+        ${STRATEGY_SOURCES}
+    )
+    target_compile_definitions(${STRATEGY_CLASS} PRIVATE AGISSTRATEGY_EXPORTS)
+    if (WIN32)
+        target_compile_definitions(${STRATEGY_CLASS} PRIVATE MYDLL_EXPORTS)
+    endif()
+    target_include_directories(${STRATEGY_CLASS} PRIVATE
+        "${CMAKE_CURRENT_SOURCE_DIR}"
+        "{AGIS_CORE_INCLUDE}"
+        "{AGIS_CORE_INCLUDE}/external/include"
+    )
+    target_link_libraries(${STRATEGY_CLASS} PRIVATE "${AGIS_CORE_PATH}")
+
+    # all libraries of a configuration go to one folder for Nexus to link, dlls are runtime output and
+    # shared objects library output. Only the registry wrappers are exported.
+    set_target_properties(${STRATEGY_CLASS} PROPERTIES
+        POSITION_INDEPENDENT_CODE ON
+        CXX_VISIBILITY_PRESET hidden
+        VISIBILITY_INLINES_HIDDEN ON
+        PREFIX ""
+        RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/strategy_libs/$<CONFIG>"
+        LIBRARY_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/strategy_libs/$<CONFIG>"
+    )
+    nexus_pgo_target(${STRATEGY_CLASS})
+endfunction()
+
+{STRATEGY_LIBRARIES}
+)";
+	std::string strategy_libraries;
+	for (auto const& [strategy_class, strategy_folder] : strategy_units)
+	{
+		strategy_libraries += "add_strategy_library(" + strategy_class + " \"" + strategy_folder + "\")\n";
+	}
+	// only the quoted placeholder, ${AGIS_CORE_PATH} references the variable it sets
+	str_replace_all(cmake_content, "\"{AGIS_CORE_PATH}\"", "\"" + this->agis_lib_path + "\"");
+	str_replace_all(cmake_content, "{AGIS_CORE_INCLUDE}", this->agis_include_path);
+	str_replace_all(cmake_content, "{PGO_CMAKE}", nexus_pgo_cmake);
+	str_replace_all(cmake_content, "{STRATEGY_LIBRARIES}", strategy_libraries);
+	AGIS_TRY(nexus_write_if_changed(this->env_path / "CmakeLists.txt", cmake_content);)
+}
 
-	// Convert the multi-byte string to wide character string
-	MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, wideCharString, bufferSize);
 
-	// Return the wide character string
-	return wideCharString;
+//============================================================================
+NexusStrategyLibrary::NexusStrategyLibrary(fs::path const& source, fs::path const& loaded_path, NexusLibraryHandle handle) :
+	loaded_path(loaded_path),
+	handle(handle)
+{
+	std::error_code ec;
+	this->write_time = fs::last_write_time(source, ec);
+	this->size = fs::file_size(source, ec);
 }
 
 
 //============================================================================
-void NexusEnv::__link(bool assume_live)
+NexusStrategyLibrary::~NexusStrategyLibrary()
+{
+	nexus_library_close(this->handle);
+	std::error_code ec;
+	fs::remove(this->loaded_path, ec);
+	qDebug() << "Unloaded strategy library: " << QString::fromStdString(this->loaded_path.filename().string());
+}
+
+
+//============================================================================
+bool NexusStrategyLibrary::is_current(fs::path const& source) const
 {
-	// before attempting to link reset hydra to reset the cash levels of the portfolio 
-	this->__reset();
+	std::error_code ec;
+	auto source_time = fs::last_write_time(source, ec);
+	if (ec) return false;
+	auto source_size = fs::file_size(source, ec);
+	return !ec && source_time == this->write_time && source_size == this->size;
+}
 
+
+//============================================================================
+void NexusEnv::__link(bool assume_live)
+{
 	qDebug() << "============================================================================";
 	qDebug() << "Linking strategies...";
-	// AgisCore dll file
-	fs::path output_dir = this->env_path / "build" / build_method;
-	fs::path agis_strategy_dll = output_dir / "AgisStrategy.dll";
+	std::vector<fs::path> sources;
+	if (!this->per_strategy_libs) {
+		// AgisCore dll file
+		fs::path agis_strategy_dll = this->env_path / "build" / build_method / ("AgisStrategy" + nexus_library_extension);
+		if (!fs::exists(agis_strategy_dll)) AGIS_THROW("Failed to locate AgisStrategy" + nexus_library_extension);
+		sources.push_back(agis_strategy_dll);
+	}
+	else {
+		fs::path output_dir = this->env_path / "build" / "strategy_libs" / build_method;
+		if (!fs::exists(output_dir)) AGIS_THROW("Failed to locate strategy libraries in: " + output_dir.string());
+		for (auto const& entry : fs::directory_iterator(output_dir))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == nexus_library_extension) sources.push_back(entry.path());
+		}
+	}
+
+	// copies left behind by a previous session are not loaded by anyone, those still in use fail to remove
+	auto loaded_folder = this->env_path / "build" / "loaded";
+	if (fs::exists(loaded_folder)) {
+		std::set<fs::path> in_use;
+		for (auto const& [id, library] : this->strategy_owners) in_use.insert(library->loaded_path);
+		for (auto const& [name, library] : this->strategy_libraries) in_use.insert(library->loaded_path);
+		for (auto const& entry : fs::directory_iterator(loaded_folder))
+		{
+			std::error_code ec;
+			if (!in_use.contains(entry.path())) fs::remove(entry.path(), ec);
+		}
+	}
+
+	// load every library that was rebuilt next to the running version and swap in its strategies,
+	// strategies of unchanged libraries are left linked. One library failing doesn't block the rest.
+	std::vector<std::string> errors;
+	for (auto const& source : sources)
+	{
+		auto name = source.stem().string();
+		auto it = this->strategy_libraries.find(name);
+		if (it != this->strategy_libraries.end() && it->second->is_current(source)) {
+			qDebug() << "Library unchanged: " << QString::fromStdString(name);
+			continue;
+		}
+		try {
+			this->__load_library(source, assume_live);
+		}
+		catch (std::exception& e) {
+			errors.push_back(name + ": " + e.what());
+		}
+	}
+	if (!errors.empty()) {
+		std::string msg = "Failed to link strategy libraries:";
+		for (auto const& error : errors) msg += "\n" + error;
+		AGIS_THROW(msg);
+	}
+	qDebug() << "Linking strategies complete";
+	qDebug() << "============================================================================";
+}
+
+
+//============================================================================
+void NexusEnv::__load_library(fs::path const& source, bool assume_live)
+{
+	auto loaded_folder = this->env_path / "build" / "loaded";
+	fs::create_directories(loaded_folder);
+	auto name = source.stem().string();
+	fs::path loaded_path;
+	do {
+		loaded_path = loaded_folder / (name + "." + std::to_string(++this->library_version) + nexus_library_extension);
+	} while (fs::exists(loaded_path));
+	fs::copy_file(source, loaded_path);
+
+	NexusLibraryHandle handle = nexus_library_open(loaded_path);
+	if (!handle) {
+		auto error = nexus_library_error();
+		std::error_code ec;
+		fs::remove(loaded_path, ec);
+		AGIS_THROW("Failed to load library: " + source.string() + " (" + error + ")");
+	}
+	auto library = std::make_shared<NexusStrategyLibrary>(source, loaded_path, handle);
+	qDebug() << "Loaded strategy library: " << QString::fromStdString(loaded_path.filename().string());
+	std::shared_ptr<NexusStrategyLibrary> previous = nullptr;
+	if (auto it = this->strategy_libraries.find(name); it != this->strategy_libraries.end()) previous = it->second;
+	this->__link_library(library, assume_live);
+	this->strategy_libraries[name] = library;
+	if (!previous) return;
+
+	// classes the new version no longer registers, e.g. replaced by a native kernel, go back to their abstract strategy
+	std::vector<std::string> stale;
+	for (auto const& [strategy_id, owner] : this->strategy_owners)
+	{
+		if (owner == previous) stale.push_back(strategy_id);
+	}
+	for (auto const& strategy_id : stale)
+	{
+		if (this->hydra.strategy_exists(strategy_id)) this->hydra.remove_strategy(strategy_id);
+		this->strategy_owners.erase(strategy_id);
+		if (!strategy_id.ends_with("_CPP")) continue;
+		auto abstract_strategy_id = strategy_id.substr(0, strategy_id.size() - 4);
+		if (this->hydra.strategy_exists(abstract_strategy_id)) {
+			this->hydra.__set_strategy_is_live(abstract_strategy_id, true);
+			qDebug() << "Enabling abstract strategy: " + abstract_strategy_id;
+		}
+	}
+	NexusNativeKernels::instance().release(previous);
+}
 
-	this->AgisStrategyDLL = LoadLibrary(StringToLPCWSTR(agis_strategy_dll.string()));
-	if (!AgisStrategyDLL) AGIS_THROW("Failed to locate AgisStrategy.dll");
 
+//============================================================================
+void NexusEnv::__link_library(std::shared_ptr<NexusStrategyLibrary> const& library, bool assume_live)
+{
 	// Get the function pointer for getRegistry
 	using GetRegistryWrapperFunc = StrategyRegistry::RegistryMap & (*)();
 	using GetIDRegistryWrapperFunc = StrategyRegistry::PortfolioIdMap& (*)();
 
-	GetRegistryWrapperFunc getRegistryWrapperFunc = reinterpret_cast<GetRegistryWrapperFunc>(GetProcAddress(AgisStrategyDLL, "getRegistryWrapper"));
-	GetIDRegistryWrapperFunc getIDRegistryWrapperFunc = reinterpret_cast<GetIDRegistryWrapperFunc>(GetProcAddress(AgisStrategyDLL, "getIDRegistryWrapper"));
+	GetRegistryWrapperFunc getRegistryWrapperFunc = reinterpret_cast<GetRegistryWrapperFunc>(nexus_library_symbol(library->handle, "getRegistryWrapper"));
+	GetIDRegistryWrapperFunc getIDRegistryWrapperFunc = reinterpret_cast<GetIDRegistryWrapperFunc>(nexus_library_symbol(library->handle, "getIDRegistryWrapper"));
 	if (!getRegistryWrapperFunc || !getIDRegistryWrapperFunc)
 	{
 		AGIS_THROW("Failed to get function pointer for strategy registries");
@@ -746,6 +1242,9 @@ void NexusEnv::__link(bool assume_live)
 
 		AGIS_TRY(this->hydra.register_strategy(std::move(strategy)));
 
+		// the strategy now runs code from this version, the previous version unloads once nothing else uses it
+		this->strategy_owners[strategy_id] = library;
+
 		// check if the linked strategy is replacing abstract strategy
 		std::string sub_string = "_CPP";
 		if (strategy_id.length() >= sub_string.length() &&
@@ -762,9 +1261,39 @@ void NexusEnv::__link(bool assume_live)
 
 		qDebug() << "Strategy: " + strategy_id + " linked";
 	}
-	this->agis_strategy_dll_loaded = true;
-	qDebug() << "Linking strategies complete";
-	qDebug() << "============================================================================";
+
+	// native kernels are looked up by the exchange views of the abstract strategies they were generated for
+	for (auto const& strategy_pair : this->hydra.__get_strategy_map().__get_strategies())
+	{
+		auto const& strategy = strategy_pair.second;
+		if (!strategy->__is_abstract_class()) continue;
+		auto symbol = nexus_native_symbol(strategy->get_strategy_id());
+		auto function = reinterpret_cast<NexusNativeKernelFunction>(nexus_library_symbol(library->handle, symbol.c_str()));
+		auto hash = reinterpret_cast<NexusNativeKernelHashFunction>(nexus_library_symbol(library->handle, (symbol + "_hash").c_str()));
+		if (!function || !hash) continue;
+		NexusNativeKernels::instance().set(strategy->get_strategy_id(), hash(), function, library);
+		qDebug() << "Native kernel: " + strategy->get_strategy_id() + " linked";
+	}
+}
+
+
+//============================================================================
+std::optional<std::string> NexusEnv::source_strategy(fs::path const& file) const
+{
+	// strategies/<strategy id>/ holds a strategy's sources and generated code, registry/<class>.cpp registers <class>
+	std::error_code ec;
+	auto relative = fs::relative(fs::weakly_canonical(file, ec), fs::weakly_canonical(this->env_path, ec), ec);
+	if (ec || relative.empty()) return std::nullopt;
+	auto it = relative.begin();
+	auto folder = it->string();
+	if (++it == relative.end()) return std::nullopt;
+	if (folder == "strategies") return it->string();
+	if (folder == "registry") {
+		auto strategy_class = relative.stem().string();
+		if (strategy_class.ends_with("_CPP")) strategy_class.resize(strategy_class.size() - 4);
+		return strategy_class;
+	}
+	return std::nullopt;
 }
 
 
@@ -772,6 +1301,8 @@ void NexusEnv::__link(bool assume_live)
 void NexusEnv::__reset()
 {
 	this->hydra.__reset();
+	NexusAvailability::instance().clear();
+	NexusFeatureCache::instance().clear();
 }
 
 
@@ -781,6 +1312,12 @@ void NexusEnv::clear()
 	this->remove_editors();
 	this->reset_trees();
 	this->hydra.clear();
+	this->exchange_caches.clear();
+	NexusAvailability::instance().clear();
+	NexusFeatureCache::instance().clear();
+	NexusNativeKernels::instance().clear();
+	this->strategy_owners.clear();
+	this->strategy_libraries.clear();
 }
 
 
@@ -789,7 +1326,14 @@ AgisResult<bool> NexusEnv::restore_strategies(const rapidjson::Document& j)
 {
 	// Restore CPP strategy tree by linking to all strats if the AgisStrategy library
 	fs::path output_dir = this->env_path / "build" / build_method;
-	fs::path agis_strategy_dll = output_dir / "AgisStrategy.dll";
+	fs::path agis_strategy_dll = output_dir / ("AgisStrategy" + nexus_library_extension);
+
+	// settings are restored after the strategies, the link mode is needed to find the libraries
+	if (j.HasMember("per_strategy_libs") && j["per_strategy_libs"].IsBool())
+	{
+		this->per_strategy_libs = j["per_strategy_libs"].GetBool();
+	}
+	if (this->per_strategy_libs) agis_strategy_dll = this->env_path / "build" / "strategy_libs" / build_method;
 
 	// If agis_strategy_dll exists, call __link
 	if (fs::exists(agis_strategy_dll))
@@ -840,48 +1384,58 @@ AgisResult<bool> NexusEnv::restore_strategies(const rapidjson::Document& j)
 	auto& strategy_map = this->hydra.__get_strategy_map();
 	auto& strategies = strategy_map.__get_strategies();
 
-	// node currently widgets are created for each one in order to restore the strategy
-	// probably way to this without creating them.
+	// compile the flow graphs of all abstract strategies in parallel straight from the json, no node
+	// widgets are created. The strategies themselves are updated on this thread afterwards.
+	std::vector<AgisStrategy*> abstract_strategies;
 	for (auto& strategy_pair : strategies)
 	{
 		auto& strategy = strategy_pair.second;
-		if (!strategy->__is_abstract_class()) { continue; }
-		auto strat_path = strat_folder / strategy->get_strategy_id() / "graph.flow";
-		
-		// use node model to load in flow graph to set absract strategy lambda
-		std::shared_ptr<NodeDelegateModelRegistry> registry = registerDataModels();
-		DataFlowGraphModel dataFlowGraphModel = DataFlowGraphModel(registry);
-		ExchangeModel::hydra = this->get_hydra();
-
-		QFile file(strat_path);
-		if (!file.open(QIODevice::ReadOnly)) {
-			auto msg = "Failed to open the strategy flow file: " + strat_path.string();
-			return AgisResult<bool>(AGIS_EXCEP(msg));
+		if (strategy->__is_abstract_class()) abstract_strategies.push_back(strategy.get());
+	}
+	ExchangeModel::hydra = this->get_hydra();
+
+	std::vector<std::optional<ExchangeViewLambdaStruct>> compiled(abstract_strategies.size());
+	std::vector<std::string> load_errors(abstract_strategies.size());
+	std::vector<std::string> compile_errors(abstract_strategies.size());
+	std::vector<size_t> indices(abstract_strategies.size());
+	std::iota(indices.begin(), indices.end(), 0);
+	auto hydra_ptr = this->get_hydra();
+	std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+		auto strat_path = strat_folder / abstract_strategies[i]->get_strategy_id() / "graph.flow";
+		QJsonObject flow;
+		try {
+			flow = nexus_read_flow(strat_path);
 		}
-
-		QByteArray const wholeFile = file.readAll();
-		file.close();
-
-		QJsonParseError error;
-		QJsonDocument jsonDocument = QJsonDocument::fromJson(wholeFile, &error);
-		if (error.error != QJsonParseError::NoError) {
-			auto msg = "Failed to parse JSON in the strategy flow file: " + error.errorString().toStdString();
-			return AgisResult<bool>(AGIS_EXCEP(msg));
+		catch (std::exception& e) {
+			load_errors[i] = e.what();
+			return;
+		}
+		try {
+			compiled[i] = nexus_compile_flow(flow, hydra_ptr);
 		}
+		catch (std::exception& e) {
+			compile_errors[i] = e.what();
+		}
+	});
 
-		if (!jsonDocument.isObject()) {
-			return AgisResult<bool>(AGIS_EXCEP("Invalid JSON format in the strategy flow file."));
+	for (size_t i = 0; i < abstract_strategies.size(); i++)
+	{
+		if (!load_errors[i].empty()) {
+			return AgisResult<bool>(AGIS_EXCEP(load_errors[i]));
 		}
-		dataFlowGraphModel.load(jsonDocument.object());
 
 		// case to abstract strategy and extract strategy
-		auto abstract_strategy = dynamic_cast<AbstractAgisStrategy*>(strategy.get());
-		abstract_strategy->set_abstract_ev_lambda([&dataFlowGraphModel]() {
-			return NexusNodeEditor::__extract_abstract_strategy(&dataFlowGraphModel);
+		auto strategy = abstract_strategies[i];
+		auto abstract_strategy = dynamic_cast<AbstractAgisStrategy*>(strategy);
+		auto ev_lambda_struct = compiled[i];
+		abstract_strategy->set_abstract_ev_lambda([ev_lambda_struct]() {
+			return ev_lambda_struct;
 		});
 		auto res = abstract_strategy->extract_ev_lambda();
-		if (res.is_exception()) abstract_strategy->set_is_live(false);
-		qDebug() << "Disabling abstract strategy, invalid flow graph: " + strategy->get_strategy_id();
+		if (!compile_errors[i].empty() || res.is_exception()) {
+			abstract_strategy->set_is_live(false);
+			qDebug() << "Disabling abstract strategy, invalid flow graph: " + strategy->get_strategy_id();
+		}
 	}
 
 	// build the hydra instance to allow for the strategy map to get populated
@@ -916,6 +1470,16 @@ AgisResult<bool> NexusEnv::restore_settings(rapidjson::Document const& j)
 		this->agis_pyd_path = j["agis_pyd_path"].GetString();
 	}
 
+	if (j.HasMember("per_strategy_libs") && j["per_strategy_libs"].IsBool())
+	{
+		this->per_strategy_libs = j["per_strategy_libs"].GetBool();
+	}
+
+	if (j.HasMember("build_jobs") && j["build_jobs"].IsUint64())
+	{
+		this->build_jobs = j["build_jobs"].GetUint64();
+	}
+
 	return AgisResult<bool>(true);
 }
 
@@ -936,7 +1500,7 @@ AgisResult<bool> NexusEnv::set_settings(NexusSettings* nexus_settings)
 	{
 		return AgisResult<bool>(AGIS_EXCEP("Invalid AGIS DLL path: " + q_string.toStdString()));
 	}
-	else if (q_string.right(4) != ".dll")
+	else if (fs::path(q_string.toStdString()).extension() != nexus_library_extension)
 	{
 		return AgisResult<bool>(AGIS_EXCEP("Invalid AGIS DLL path: " + q_string.toStdString()));
 	}
@@ -962,6 +1526,10 @@ AgisResult<bool> NexusEnv::set_settings(NexusSettings* nexus_settings)
 	}
 	else this->agis_build_method = "\"" + q_string.toStdString() + "\"";
 
+	// ===== strategy libraries =====
+	this->per_strategy_libs = nexus_settings->get_per_strategy_libs();
+	this->build_jobs = nexus_settings->get_build_jobs();
+
 	return AgisResult<bool>(true);
 }
 
@@ -1009,23 +1577,47 @@ NexusEnv::save_env(rapidjson::Document &j)
 	j.AddMember("agis_include_path", rapidjson::StringRef(this->agis_include_path.c_str()), allocator);
 	j.AddMember("agis_lib_path", rapidjson::StringRef(this->agis_lib_path.c_str()), allocator);
 	j.AddMember("agis_pyd_path", rapidjson::StringRef(this->agis_pyd_path.c_str()), allocator);
+	j.AddMember("per_strategy_libs", this->per_strategy_libs, allocator);
+	j.AddMember("build_jobs", static_cast<uint64_t>(this->build_jobs), allocator);
+
+	// the binary snapshot restores without parsing, json is only written on export
+	try {
+		auto start = std::chrono::high_resolution_clock::now();
+		NexusSnapshot::write(this->get_env_snapshot_path(), j);
+		auto end = std::chrono::high_resolution_clock::now();
+		qDebug() << "Environemnt saved in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " Ms";
+		return true;
+	}
+	catch (std::exception& e) {
+		qDebug() << "Environemnt failed to saved: " << e.what();
+		return false;
+	}
+}
+
+
+//============================================================================
+std::expected<bool, AgisException>
+NexusEnv::export_env_json()
+{
+	std::unique_ptr<NexusSnapshot> snapshot;
+	try {
+		snapshot = NexusSnapshot::read(this->get_env_snapshot_path());
+	}
+	catch (std::exception& e) {
+		return std::unexpected<AgisException>(AGIS_EXCEP(std::string(e.what())));
+	}
 
 	// Dump the JSON output to a file
 	rapidjson::StringBuffer buffer;
 	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-	j.Accept(writer);
+	snapshot->document().Accept(writer);
 
-	std::string jsonString = buffer.GetString();
-	auto json_path = this->env_path / "env_settings.json";
+	auto json_path = this->get_env_settings_path();
 	std::ofstream outputFile(json_path.string());
-	if (outputFile.is_open()) {
-		outputFile << jsonString;
-		outputFile.close();
-		qDebug() << "Environemnt saved";
-		return true;
-	}
-	else {
-		qDebug() << "Environemnt failed to saved";
-		return false;
+	if (!outputFile.is_open()) {
+		return std::unexpected<AgisException>(AGIS_EXCEP("Failed to write: " + json_path.string()));
 	}
+	outputFile << buffer.GetString();
+	qDebug() << "Environemnt exported to " << QString::fromStdString(json_path.string());
+	return true;
 }
\ No newline at end of file
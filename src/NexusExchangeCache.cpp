@@ -0,0 +1,391 @@
+#include "NexusExchangeCache.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <QDebug>
+#include <QFile>
+
+#include "NexusCodeGen.h"
+
+#include "Asset/Asset.h"
+
+static_assert(std::endian::native == std::endian::little, "exchange caches are stored little endian");
+
+static constexpr char cache_magic[4] = { 'N', 'X', 'E', 'C' };
+static constexpr size_t cache_header_size = 4 + sizeof(uint32_t) + 4 * sizeof(uint64_t);
+static constexpr size_t cache_alignment = 64;
+
+
+//============================================================================
+uint64_t nexus_exchange_source_key(fs::path const& source, std::string const& dt_format)
+{
+	// relative paths so moving the env with its data keeps the cache valid, sorted as the iteration order isn't
+	std::vector<std::string> entries;
+	auto add_entry = [&entries](fs::path const& file, std::string const& name) {
+		std::error_code ec;
+		auto size = fs::file_size(file, ec);
+		auto write_time = fs::last_write_time(file, ec).time_since_epoch().count();
+		entries.push_back(name + ":" + std::to_string(size) + ":" + std::to_string(write_time));
+	};
+	std::error_code ec;
+	if (fs::is_directory(source, ec)) {
+		// the range-for increment throws, a file removed mid walk only ends it early
+		auto it = fs::recursive_directory_iterator(source, ec);
+		for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+		{
+			std::error_code entry_ec;
+			if (!it->is_regular_file(entry_ec)) continue;
+			add_entry(it->path(), fs::relative(it->path(), source, entry_ec).generic_string());
+		}
+	}
+	else if (fs::exists(source, ec)) {
+		add_entry(source, source.filename().generic_string());
+	}
+	std::sort(entries.begin(), entries.end());
+
+	std::string signature = "v" + std::to_string(NexusExchangeCache::version) + ";" + dt_format + ";";
+	for (auto const& entry : entries) signature += entry + ";";
+	return nexus_content_hash(signature);
+}
+
+
+//============================================================================
+template <typename T>
+static void put(std::ofstream& file, T value)
+{
+	file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+
+//============================================================================
+static void put_string(std::ofstream& file, std::string const& str)
+{
+	put(file, static_cast<uint32_t>(str.size()));
+	file.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+
+//============================================================================
+static uint64_t align(std::ofstream& file)
+{
+	auto offset = static_cast<uint64_t>(file.tellp());
+	static constexpr char zeros[cache_alignment] = {};
+	auto padding = (cache_alignment - offset % cache_alignment) % cache_alignment;
+	file.write(zeros, static_cast<std::streamsize>(padding));
+	return offset + padding;
+}
+
+
+/// <summary>
+/// Directory entry of an asset while the cache is written
+/// </summary>
+struct CachedAsset
+{
+	std::string asset_id;
+	uint64_t rows;
+	uint64_t data_offset;
+	uint64_t dt_offset;
+	std::vector<std::string> columns;
+};
+
+
+//============================================================================
+void NexusExchangeCache::write(fs::path const& path, uint64_t key, ExchangePtr const& exchange)
+{
+	auto temp_path = path;
+	temp_path += ".tmp";
+	if (path.has_parent_path()) fs::create_directories(path.parent_path());
+	std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to write exchange cache: " + temp_path.string());
+	}
+
+	// the merged index of the exchange is the union of the asset indexes
+	auto const& exchange_assets = exchange->get_assets();
+	std::vector<long long> dt_index;
+	for (auto const& asset : exchange_assets)
+	{
+		if (!asset) continue;
+		auto asset_index = asset->__get_dt_index(false);
+		std::vector<long long> merged;
+		merged.reserve(dt_index.size() + asset_index.size());
+		std::set_union(dt_index.begin(), dt_index.end(), asset_index.begin(), asset_index.end(), std::back_inserter(merged));
+		dt_index.swap(merged);
+	}
+
+	file.write(cache_magic, sizeof(cache_magic));
+	put(file, version);
+	put(file, key);
+	put(file, static_cast<uint64_t>(dt_index.size()));
+	put(file, uint64_t(0));		// asset count
+	put(file, uint64_t(0));		// directory offset
+	align(file);
+	file.write(reinterpret_cast<char const*>(dt_index.data()), static_cast<std::streamsize>(dt_index.size() * sizeof(long long)));
+
+	std::vector<CachedAsset> directory;
+	for (auto const& asset : exchange_assets)
+	{
+		if (!asset) continue;
+		auto rows = static_cast<uint64_t>(asset->get_rows());
+		auto cols = static_cast<uint64_t>(asset->get_cols());
+		auto const& data = asset->__get__data();
+		auto asset_index = asset->__get_dt_index(false);
+		if (data.size() < rows * cols || asset_index.size() < rows) continue;
+
+		// column names in the order of the data columns
+		CachedAsset entry{ asset->get_asset_id(), rows, 0, 0, std::vector<std::string>(cols) };
+		for (auto const& [name, i] : asset->get_headers())
+		{
+			if (i < cols) entry.columns[i] = name;
+		}
+		entry.data_offset = align(file);
+		file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(rows * cols * sizeof(double)));
+		entry.dt_offset = align(file);
+		file.write(reinterpret_cast<char const*>(asset_index.data()), static_cast<std::streamsize>(rows * sizeof(long long)));
+		directory.push_back(std::move(entry));
+	}
+
+	auto directory_offset = static_cast<uint64_t>(file.tellp());
+	for (auto const& entry : directory)
+	{
+		put_string(file, entry.asset_id);
+		put(file, entry.rows);
+		put(file, entry.data_offset);
+		put(file, entry.dt_offset);
+		put(file, static_cast<uint32_t>(entry.columns.size()));
+		for (auto const& column : entry.columns) put_string(file, column);
+	}
+	file.seekp(4 + sizeof(uint32_t) + 2 * sizeof(uint64_t));
+	put(file, static_cast<uint64_t>(directory.size()));
+	put(file, directory_offset);
+	file.close();
+	if (!file) {
+		throw std::runtime_error("Failed to write exchange cache: " + temp_path.string());
+	}
+
+	std::error_code ec;
+	fs::rename(temp_path, path, ec);
+	if (ec) {
+		fs::remove(temp_path, ec);
+		throw std::runtime_error("Failed to replace exchange cache: " + path.string());
+	}
+}
+
+
+/// <summary>
+/// Bounds checked cursor over the mapped directory
+/// </summary>
+struct CacheReader
+{
+	unsigned char const* pos;
+	unsigned char const* end;
+
+	bool has(size_t n) const noexcept { return static_cast<size_t>(this->end - this->pos) >= n; }
+
+	template <typename T>
+	bool get(T& value) noexcept
+	{
+		if (!this->has(sizeof(T))) return false;
+		std::memcpy(&value, this->pos, sizeof(T));
+		this->pos += sizeof(T);
+		return true;
+	}
+
+	bool get(std::string_view& value) noexcept
+	{
+		uint32_t length;
+		if (!this->get(length) || !this->has(length)) return false;
+		value = std::string_view(reinterpret_cast<char const*>(this->pos), length);
+		this->pos += length;
+		return true;
+	}
+};
+
+
+//============================================================================
+NexusExchangeCache::~NexusExchangeCache()
+{
+	if (this->file && this->map) this->file->unmap(this->map);
+}
+
+
+//============================================================================
+std::shared_ptr<NexusExchangeCache const> NexusExchangeCache::open(fs::path const& path, uint64_t key)
+{
+	std::error_code ec;
+	if (!fs::exists(path, ec)) return nullptr;
+	std::shared_ptr<NexusExchangeCache> cache(new NexusExchangeCache());
+	cache->file = std::make_unique<QFile>(QString::fromStdWString(path.wstring()));
+	if (!cache->file->open(QIODevice::ReadOnly)) return nullptr;
+	auto size = static_cast<uint64_t>(cache->file->size());
+	if (size < cache_header_size) return nullptr;
+	cache->map = cache->file->map(0, static_cast<qint64>(size));
+	if (!cache->map) return nullptr;
+
+	// only the header and the directory are read, the data pages fault in when an asset is used
+	CacheReader header{ cache->map, cache->map + size };
+	char magic[4];
+	uint32_t file_version;
+	uint64_t file_key, dt_count, asset_count, directory_offset;
+	header.get(magic);
+	header.get(file_version);
+	header.get(file_key);
+	header.get(dt_count);
+	header.get(asset_count);
+	header.get(directory_offset);
+	if (std::memcmp(magic, cache_magic, sizeof(cache_magic)) != 0 || file_version != version || file_key != key) return nullptr;
+
+	auto in_bounds = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+	auto dt_offset = (cache_header_size + cache_alignment - 1) / cache_alignment * cache_alignment;
+	if (dt_count > size / sizeof(long long) || !in_bounds(dt_offset, dt_count * sizeof(long long))) return nullptr;
+	cache->dt_index = { reinterpret_cast<long long const*>(cache->map + dt_offset), dt_count };
+
+	if (directory_offset > size) return nullptr;
+	CacheReader directory{ cache->map + directory_offset, cache->map + size };
+	for (uint64_t i = 0; i < asset_count; i++)
+	{
+		NexusMappedAsset asset;
+		uint64_t rows, data_offset, index_offset;
+		uint32_t cols;
+		if (!directory.get(asset.asset_id) || !directory.get(rows) || !directory.get(data_offset)
+			|| !directory.get(index_offset) || !directory.get(cols)) {
+			return nullptr;
+		}
+		asset.columns.resize(cols);
+		for (auto& column : asset.columns)
+		{
+			if (!directory.get(column)) return nullptr;
+		}
+		if (rows > size / sizeof(double) || (cols && rows * cols > size / sizeof(double))) return nullptr;
+		if (!in_bounds(data_offset, rows * cols * sizeof(double)) || !in_bounds(index_offset, rows * sizeof(long long))) return nullptr;
+		asset.rows = rows;
+		asset.data = { reinterpret_cast<double const*>(cache->map + data_offset), rows * cols };
+		asset.dt_index = { reinterpret_cast<long long const*>(cache->map + index_offset), rows };
+		cache->assets.emplace(asset.asset_id, std::move(asset));
+	}
+	return cache;
+}
+
+
+//============================================================================
+NexusMappedAsset const* NexusExchangeCache::get_asset(std::string const& asset_id) const
+{
+	auto it = this->assets.find(std::string_view(asset_id));
+	return it == this->assets.end() ? nullptr : &it->second;
+}
+
+
+//============================================================================
+NexusExchangeCacheWriter::~NexusExchangeCacheWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+		this->queue.clear();
+	}
+	this->queued.notify_one();
+	if (this->worker.joinable()) this->worker.join();
+}
+
+
+//============================================================================
+void NexusExchangeCacheWriter::schedule(std::string const& exchange_id, ExchangePtr const& exchange, fs::path const& path)
+{
+	this->remove(exchange_id);
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto generation = ++this->generation;
+	this->entries[exchange_id] = Entry{ path, generation, false, std::nullopt, nullptr };
+	for (auto const& asset : exchange->get_assets())
+	{
+		if (asset) this->asset_exchanges[asset->get_asset_id()] = exchange_id;
+	}
+	this->queue.push_back(Job{ exchange_id, exchange, path, generation });
+	if (!this->worker.joinable()) this->worker = std::thread(&NexusExchangeCacheWriter::run, this);
+	this->queued.notify_one();
+}
+
+
+//============================================================================
+void NexusExchangeCacheWriter::remove(std::string const& exchange_id)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries.erase(exchange_id);
+	std::erase_if(this->queue, [&exchange_id](Job const& job) { return job.exchange_id == exchange_id; });
+	std::erase_if(this->asset_exchanges, [&exchange_id](auto const& pair) { return pair.second == exchange_id; });
+}
+
+
+//============================================================================
+void NexusExchangeCacheWriter::clear()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries.clear();
+	this->queue.clear();
+	this->asset_exchanges.clear();
+}
+
+
+//============================================================================
+std::shared_ptr<NexusExchangeCache const> NexusExchangeCacheWriter::get(std::string const& asset_id) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto exchange_it = this->asset_exchanges.find(asset_id);
+	if (exchange_it == this->asset_exchanges.end()) return nullptr;
+	auto it = this->entries.find(exchange_it->second);
+	if (it == this->entries.end()) return nullptr;
+
+	// the key is dropped once the file is mapped, a file that fails to map is not tried again
+	auto& entry = it->second;
+	if (entry.written && entry.key) {
+		entry.cache = NexusExchangeCache::open(entry.path, *entry.key);
+		entry.key.reset();
+	}
+	return entry.cache;
+}
+
+
+//============================================================================
+void NexusExchangeCacheWriter::run()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->queued.wait(lock, [this]() { return this->stopping || !this->queue.empty(); });
+			if (this->stopping) return;
+			job = std::move(this->queue.front());
+			this->queue.pop_front();
+		}
+
+		// a cache is only reused while every source file keeps its size and modification time
+		std::optional<uint64_t> key;
+		try {
+			key = nexus_exchange_source_key(job.exchange->get_source(), job.exchange->get_dt_format());
+			if (!NexusExchangeCache::open(job.path, *key)) {
+				auto start = std::chrono::high_resolution_clock::now();
+				NexusExchangeCache::write(job.path, *key, job.exchange);
+				auto end = std::chrono::high_resolution_clock::now();
+				qDebug() << "Exchange cache written for " << QString::fromStdString(job.exchange_id) << " in "
+					<< std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " Ms";
+			}
+		}
+		catch (std::exception& e) {
+			// the exchange is loaded either way, its asset windows keep copying the data
+			qDebug() << "Failed to cache exchange " << QString::fromStdString(job.exchange_id) << ": " << e.what();
+			key.reset();
+		}
+
+		// the exchange may have been replaced or removed while its cache was written
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto it = this->entries.find(job.exchange_id);
+		if (it == this->entries.end() || it->second.generation != job.generation) continue;
+		it->second.written = true;
+		it->second.key = key;
+	}
+}
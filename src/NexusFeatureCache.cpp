@@ -0,0 +1,99 @@
+#include "NexusFeatureCache.h"
+
+
+//============================================================================
+NexusFeatureCache& NexusFeatureCache::instance()
+{
+	static NexusFeatureCache cache;
+	return cache;
+}
+
+
+//============================================================================
+NexusFeatureCache::Buffer NexusFeatureCache::get(void const* exchange, long long datetime, size_t prefix_hash)
+{
+	std::shared_lock lock(this->mutex);
+	auto exchange_it = this->exchanges.find(exchange);
+	if (exchange_it == this->exchanges.end() || exchange_it->second.datetime != datetime) {
+		this->miss_count.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	auto buffer_it = exchange_it->second.buffers.find(prefix_hash);
+	if (buffer_it == exchange_it->second.buffers.end()) {
+		this->miss_count.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	this->hit_count.fetch_add(1, std::memory_order_relaxed);
+	return buffer_it->second;
+}
+
+
+//============================================================================
+void NexusFeatureCache::put(void const* exchange, long long datetime, size_t prefix_hash, std::vector<double> const& values)
+{
+	auto buffer = std::make_shared<const std::vector<double>>(values);
+	std::unique_lock lock(this->mutex);
+	auto& entries = this->exchanges[exchange];
+
+	// the exchange has stepped since the last put, everything cached for it is stale
+	if (entries.datetime != datetime) {
+		entries.buffers.clear();
+		entries.datetime = datetime;
+	}
+	entries.buffers.insert_or_assign(prefix_hash, std::move(buffer));
+}
+
+
+//============================================================================
+void NexusFeatureCache::subscribe(std::vector<size_t> const& keys)
+{
+	std::unique_lock lock(this->mutex);
+	for (auto key : keys) this->subscribers[key]++;
+}
+
+
+//============================================================================
+void NexusFeatureCache::unsubscribe(std::vector<size_t> const& keys)
+{
+	std::unique_lock lock(this->mutex);
+	for (auto key : keys)
+	{
+		auto it = this->subscribers.find(key);
+		if (it == this->subscribers.end()) continue;
+		if (--it->second == 0) this->subscribers.erase(it);
+	}
+}
+
+
+//============================================================================
+bool NexusFeatureCache::is_shared(size_t prefix_hash)
+{
+	std::shared_lock lock(this->mutex);
+	auto it = this->subscribers.find(prefix_hash);
+	return it != this->subscribers.end() && it->second > 1;
+}
+
+
+//============================================================================
+void NexusFeatureCache::clear()
+{
+	std::unique_lock lock(this->mutex);
+	this->exchanges.clear();
+	this->hit_count.store(0, std::memory_order_relaxed);
+	this->miss_count.store(0, std::memory_order_relaxed);
+}
+
+
+//============================================================================
+NexusFeatureSubscription::NexusFeatureSubscription(NexusFeatureCache& cache, std::vector<size_t> keys)
+	: cache(cache), keys(std::move(keys))
+{
+	this->cache.subscribe(this->keys);
+}
+
+
+//============================================================================
+NexusFeatureSubscription::~NexusFeatureSubscription()
+{
+	this->cache.unsubscribe(this->keys);
+}
@@ -0,0 +1,291 @@
+#include "NexusFlowCompiler.h"
+
+#include <algorithm>
+#include <map>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStringList>
+
+#include "NexusErrors.h"
+
+
+//============================================================================
+QJsonObject nexus_read_flow(fs::path const& flow_path)
+{
+	QFile file(flow_path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		throw std::runtime_error("Failed to open the strategy flow file: " + flow_path.string());
+	}
+	QByteArray const wholeFile = file.readAll();
+	file.close();
+
+	QJsonParseError error;
+	QJsonDocument jsonDocument = QJsonDocument::fromJson(wholeFile, &error);
+	if (error.error != QJsonParseError::NoError) {
+		throw std::runtime_error("Failed to parse JSON in the strategy flow file: " + error.errorString().toStdString());
+	}
+	if (!jsonDocument.isObject()) {
+		throw std::runtime_error("Invalid JSON format in the strategy flow file.");
+	}
+	return jsonDocument.object();
+}
+
+
+//============================================================================
+bool nexus_flow_requires_abstract(QJsonObject const& flow)
+{
+	for (auto const& node_value : flow["nodes"].toArray())
+	{
+		auto model_name = node_value.toObject()["internal-data"].toObject()["model-name"].toString();
+		if (model_name == "Asset Window" || model_name == "Exchange View Transform" || model_name == "Portfolio Optimizer") {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+//============================================================================
+static std::optional<TradeExitPtr> compile_trade_exit(QJsonObject const& node)
+{
+	auto exit_type = node["exit_type"].toString().toStdString();
+	auto extra_param = node["extra_param"].toString().toStdString();
+	try {
+		auto trade_exit = parse_trade_exit(
+			trade_exit_type_map.at(exit_type),
+			extra_param
+		);
+		return trade_exit.unwrap();
+	}
+	catch (std::exception&) {
+		// same as an invalid trade exit node, the allocation runs without an exit
+		return std::nullopt;
+	}
+}
+
+
+//============================================================================
+struct FlowGraph
+{
+	std::map<qint64, QJsonObject> nodes;
+	std::map<std::pair<qint64, int>, qint64> inputs;
+
+	std::optional<qint64> input_node(qint64 id, int port, QStringList const& model_names) const
+	{
+		auto it = this->inputs.find({ id, port });
+		if (it == this->inputs.end()) return std::nullopt;
+		auto node_it = this->nodes.find(it->second);
+		if (node_it == this->nodes.end() || !model_names.contains(node_it->second["model-name"].toString())) return std::nullopt;
+		return it->second;
+	}
+};
+
+
+//============================================================================
+static FlowGraph index_flow(QJsonObject const& flow)
+{
+	// index the nodes by id and the connections by their input port
+	FlowGraph graph;
+	for (auto const& node_value : flow["nodes"].toArray())
+	{
+		auto node = node_value.toObject();
+		graph.nodes[node["id"].toInteger()] = node["internal-data"].toObject();
+	}
+	for (auto const& connection_value : flow["connections"].toArray())
+	{
+		auto connection = connection_value.toObject();
+		auto in_node = connection["intNodeId"].toInteger();
+		auto in_port = connection["inPortIndex"].toInt();
+		graph.inputs[{ in_node, in_port }] = connection["outNodeId"].toInteger();
+	}
+	return graph;
+}
+
+
+//============================================================================
+struct FlowView
+{
+	qint64 alloc_id = 0;
+	qint64 ev_id = 0;
+	std::vector<qint64> transform_ids;	///< from the allocation back to the exchange view
+	ExchangePtr exchange = nullptr;
+	AgisAssetLambdaChain lambda_chain;	///< resolved against the exchange
+	NexusLambdaProgram program;
+};
+
+
+//============================================================================
+static std::optional<FlowView> walk_flow(FlowGraph const& graph, HydraPtr hydra)
+{
+	auto const& nodes = graph.nodes;
+	QStringList const lambda_models = { "Asset Lambda", "Asset Window" };
+	QStringList const transform_models = { "Exchange View Transform", "Portfolio Optimizer" };
+	FlowView view;
+
+	// probably better way to find the strategy node
+	std::optional<qint64> alloc_id = std::nullopt;
+	for (auto const& [id, node] : nodes)
+	{
+		if (node["model-name"].toString() == "Strategy Allocation") {
+			alloc_id = id;
+			break;
+		}
+	}
+	if (!alloc_id.has_value()) return std::nullopt;
+	view.alloc_id = alloc_id.value();
+	// cross sectional transforms and optimizers sit between the exchange view and the allocation
+	auto ev_id = graph.input_node(view.alloc_id, 0, { "Exchange View" });
+	auto transform_id = graph.input_node(view.alloc_id, 0, transform_models);
+	while (!ev_id.has_value() && transform_id.has_value() && view.transform_ids.size() <= nodes.size())
+	{
+		view.transform_ids.push_back(transform_id.value());
+		ev_id = graph.input_node(transform_id.value(), 0, { "Exchange View" });
+		transform_id = graph.input_node(transform_id.value(), 0, transform_models);
+	}
+	if (view.transform_ids.size() > nodes.size()) {
+		NEXUS_THROW("Cycle in the exchange view transforms");
+	}
+	if (!ev_id.has_value()) return std::nullopt;
+	view.ev_id = ev_id.value();
+	auto exchange_id = graph.input_node(view.ev_id, 1, { "Exchange" });
+	if (!exchange_id.has_value()) return std::nullopt;
+
+	auto exchange_opt = hydra->get_exchange(nodes.at(exchange_id.value())["exchange_id"].toString().toStdString());
+	if (!exchange_opt.has_value()) return std::nullopt;
+	view.exchange = exchange_opt.value();
+
+	// walk the asset lambda and window nodes back from the exchange view, then replay them in flow order
+	std::vector<qint64> lambda_ids;
+	auto lambda_id = graph.input_node(view.ev_id, 0, lambda_models);
+	while (lambda_id.has_value() && lambda_ids.size() <= nodes.size())
+	{
+		lambda_ids.push_back(lambda_id.value());
+		lambda_id = graph.input_node(lambda_id.value(), 0, lambda_models);
+	}
+	if (lambda_ids.size() > nodes.size()) {
+		NEXUS_THROW("Cycle in the asset lambda chain");
+	}
+	if (lambda_ids.empty()) return std::nullopt;
+
+	AgisAssetLambdaChain lambda_chain;
+	view.program = std::vector<NexusLambdaInstruction>{};
+	for (auto it = lambda_ids.rbegin(); it != lambda_ids.rend(); ++it)
+	{
+		auto const& node = nodes.at(*it);
+		auto column = node["column"].toString().toStdString();
+		auto row = node["row"].toString().toInt();
+		if (node["model-name"].toString() == "Asset Window") {
+			auto window_it = std::find(
+				nexus_window_strings.begin(),
+				nexus_window_strings.end(),
+				node["window_type"].toString().toStdString()
+			);
+			if (window_it == nexus_window_strings.end()) return std::nullopt;
+			NexusWindowSpec spec;
+			spec.type = static_cast<NexusWindowType>(std::distance(nexus_window_strings.begin(), window_it));
+			spec.column = column;
+			spec.period = std::max(node["period"].toString().toInt(), 1);
+			column = nexus_window_column(spec);
+			row = -(spec.period - 1);
+		}
+		nexus_push_asset_lambda(
+			lambda_chain,
+			view.program,
+			node["opperation"].toString().toStdString(),
+			column,
+			row,
+			node["filter"].toString().toStdString()
+		);
+	}
+
+	auto resolved_chain = nexus_resolve_lambda_chain(lambda_chain, view.exchange);
+	if (!resolved_chain.has_value()) return std::nullopt;
+	if (resolved_chain.value().size() == 0)
+	{
+		NEXUS_THROW("Attempting to extract strategy with no asset lambdas");
+	}
+	view.lambda_chain = std::move(resolved_chain.value());
+	return view;
+}
+
+
+//============================================================================
+std::optional<NexusFlowKernel> nexus_flow_kernel(QJsonObject const& flow, HydraPtr hydra)
+{
+	auto graph = index_flow(flow);
+	auto view = walk_flow(graph, hydra);
+	if (!view.has_value() || !view->program.has_value()) return std::nullopt;
+	auto kernel = NexusLambdaKernel::compile(view->program.value(), view->exchange);
+	if (!kernel.has_value()) return std::nullopt;
+
+	auto const& ev_node = graph.nodes.at(view->ev_id);
+	return NexusFlowKernel{
+		std::move(kernel.value()),
+		agis_query_map.at(ev_node["query_type"].toString().toStdString()),
+		ev_node["N"].toString().toInt()
+	};
+}
+
+
+//============================================================================
+std::optional<ExchangeViewLambdaStruct> nexus_compile_flow(QJsonObject const& flow, HydraPtr hydra)
+{
+	auto graph = index_flow(flow);
+	auto view_opt = walk_flow(graph, hydra);
+	if (!view_opt.has_value()) return std::nullopt;
+	auto const& view = view_opt.value();
+	auto const& nodes = graph.nodes;
+
+	auto const& ev_node = nodes.at(view.ev_id);
+	auto ev_lambda_struct = nexus_exchange_view_struct(
+		view.lambda_chain,
+		view.program,
+		view.exchange,
+		agis_query_map.at(ev_node["query_type"].toString().toStdString()),
+		ev_node["N"].toString().toInt(),
+		nexus_lambda_chain_warmup(view.lambda_chain),
+		ev_node["cross_sectional"].toBool(false),
+		ev_node["luajit"].toBool(false)
+	);
+	for (auto it = view.transform_ids.rbegin(); it != view.transform_ids.rend(); ++it)
+	{
+		auto const& node = nodes.at(*it);
+		if (node["model-name"].toString() == "Portfolio Optimizer") {
+			auto type = nexus_optimizer_type(node["objective"].toString().toStdString());
+			if (!type.has_value()) return std::nullopt;
+			NexusOptimizerSettings settings;
+			settings.type = type.value();
+			settings.risk_aversion = node["risk_aversion"].toString().toDouble();
+			settings.max_weight = node["max_weight"].toString().toDouble();
+			settings.long_only = node["long_only"].toBool(true);
+			ev_lambda_struct = nexus_optimizer_view_struct(std::move(ev_lambda_struct), settings, hydra);
+			continue;
+		}
+		auto type = nexus_transform_type(node["transform_type"].toString().toStdString());
+		if (!type.has_value()) return std::nullopt;
+		NexusViewTransform transform(type.value(), node["param"].toString().toDouble());
+		ev_lambda_struct = nexus_transform_view_struct(std::move(ev_lambda_struct), transform);
+	}
+
+	// strategy allocation, an empty ev_opp_param is how the node saves a disabled parameter
+	auto const& alloc_node = nodes.at(view.alloc_id);
+	std::optional<TradeExitPtr> trade_exit = std::nullopt;
+	auto exit_id = graph.input_node(view.alloc_id, 1, { "Trade Exit" });
+	if (exit_id.has_value()) trade_exit = compile_trade_exit(nodes.at(exit_id.value()));
+
+	std::optional<std::string> ev_opp_param = std::nullopt;
+	auto ev_opp_param_str = alloc_node["ev_opp_param"].toString().toStdString();
+	if (!ev_opp_param_str.empty()) ev_opp_param = ev_opp_param_str;
+
+	ev_lambda_struct.strat_alloc_struct = nexus_strategy_alloc_struct(
+		alloc_node["epsilon"].toString().toStdString(),
+		alloc_node["target_leverage"].toString().toStdString(),
+		alloc_node["clear_missing"].toBool(),
+		alloc_node["alloc_type"].toString().toStdString(),
+		alloc_node["ev_opp_type"].toString().toStdString(),
+		ev_opp_param,
+		trade_exit
+	);
+	return ev_lambda_struct;
+}
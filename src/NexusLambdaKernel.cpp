@@ -0,0 +1,549 @@
+#include "NexusLambdaKernel.h"
+#include "NexusAvailability.h"
+#include "NexusFeatureCache.h"
+#include "NexusLuaKernel.h"
+#include "NexusNativeKernel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#include "AgisStrategy.h"
+#include "Asset/Asset.h"
+
+using namespace Agis;
+
+
+//============================================================================
+template <typename T>
+static inline double nexus_unwrap_feature(T&& feature)
+{
+	// features are either returned directly or wrapped in an AgisResult
+	if constexpr (std::is_arithmetic_v<std::decay_t<T>>) {
+		return static_cast<double>(feature);
+	}
+	else {
+		if (feature.is_exception()) return std::numeric_limits<double>::quiet_NaN();
+		return feature.unwrap();
+	}
+}
+
+
+//============================================================================
+double nexus_load_feature(AssetPtr const& asset, size_t column_index, int row)
+{
+	if (!asset) return std::numeric_limits<double>::quiet_NaN();
+	return nexus_unwrap_feature(asset->get_asset_feature(column_index, row));
+}
+
+
+//============================================================================
+static inline double apply_opcode(NexusLambdaOpcode opcode, double a, double b)
+{
+	switch (opcode)
+	{
+		case NexusLambdaOpcode::INIT: return b;
+		case NexusLambdaOpcode::IDENTITY: return a;
+		case NexusLambdaOpcode::ADD: return a + b;
+		case NexusLambdaOpcode::SUBTRACT: return a - b;
+		case NexusLambdaOpcode::MULTIPLY: return a * b;
+		case NexusLambdaOpcode::DIVIDE: return a / b;
+		default: return a;
+	}
+}
+
+
+//============================================================================
+std::optional<NexusLambdaInstruction> nexus_lambda_instruction(std::string const& op_name, std::string const& column, int row)
+{
+	static const std::vector<std::pair<std::string, NexusLambdaOpcode>> opcodes = {
+		{"INIT", NexusLambdaOpcode::INIT},
+		{"IDENTITY", NexusLambdaOpcode::IDENTITY},
+		{"ADD", NexusLambdaOpcode::ADD},
+		{"SUBTRACT", NexusLambdaOpcode::SUBTRACT},
+		{"MULTIPLY", NexusLambdaOpcode::MULTIPLY},
+		{"DIVIDE", NexusLambdaOpcode::DIVIDE}
+	};
+	auto it = std::find_if(opcodes.begin(), opcodes.end(), [&](auto const& p) { return p.first == op_name; });
+	if (it == opcodes.end()) return std::nullopt;
+	auto op_it = agis_function_map.find(op_name);
+	if (op_it == agis_function_map.end()) return std::nullopt;
+
+	// probe the engine operation so the kernel can never silently diverge from the interpreted chain
+	static const std::pair<double, double> probes[] = { {3.0, 7.0}, {-2.5, 0.5}, {11.0, -4.0} };
+	for (auto const& [a, b] : probes)
+	{
+		if (op_it->second(a, b) != apply_opcode(it->second, a, b)) return std::nullopt;
+	}
+
+	NexusLambdaInstruction instruction;
+	instruction.opcode = it->second;
+	instruction.column = column;
+	instruction.row = row;
+	if (auto spec = nexus_parse_window_column(column)) {
+		instruction.window = spec->type;
+		instruction.period = spec->period;
+		instruction.column = spec->column;
+		instruction.row = 0;
+	}
+	return instruction;
+}
+
+
+//============================================================================
+static std::optional<double> parse_bound(std::string s)
+{
+	s.erase(std::remove_if(s.begin(), s.end(), [](unsigned char c) { return std::isspace(c); }), s.end());
+	if (s == "inf" || s == "+inf") return std::numeric_limits<double>::infinity();
+	if (s == "-inf") return -std::numeric_limits<double>::infinity();
+	try {
+		size_t pos = 0;
+		double value = std::stod(s, &pos);
+		if (pos != s.size()) return std::nullopt;
+		return value;
+	}
+	catch (std::exception&) {
+		return std::nullopt;
+	}
+}
+
+
+//============================================================================
+std::optional<NexusLambdaInstruction> nexus_filter_instruction(std::string const& filter)
+{
+	auto first = filter.find_first_not_of(" \t");
+	auto last = filter.find_last_not_of(" \t");
+	if (first == std::string::npos || last <= first) return std::nullopt;
+	char open = filter[first];
+	char close = filter[last];
+	if ((open != '[' && open != '(') || (close != ']' && close != ')')) return std::nullopt;
+
+	auto body = filter.substr(first + 1, last - first - 1);
+	auto comma = body.find(',');
+	if (comma == std::string::npos) return std::nullopt;
+	auto lower = parse_bound(body.substr(0, comma));
+	auto upper = parse_bound(body.substr(comma + 1));
+	if (!lower.has_value() || !upper.has_value()) return std::nullopt;
+
+	NexusLambdaInstruction instruction;
+	instruction.opcode = NexusLambdaOpcode::FILTER;
+	instruction.lower = lower.value();
+	instruction.upper = upper.value();
+	instruction.lower_inclusive = open == '[';
+	instruction.upper_inclusive = close == ']';
+	return instruction;
+}
+
+
+//============================================================================
+std::string nexus_filter_string(NexusLambdaInstruction const& instruction)
+{
+	auto bound = [](double x) -> std::string {
+		if (std::isinf(x)) return x > 0 ? "inf" : "-inf";
+		std::string s = std::to_string(x);
+		s.erase(s.find_last_not_of('0') + 1);
+		if (s.back() == '.') s.pop_back();
+		return s;
+	};
+	return std::string(instruction.lower_inclusive ? "[" : "(") + bound(instruction.lower) + ","
+		+ bound(instruction.upper) + (instruction.upper_inclusive ? "]" : ")");
+}
+
+
+//============================================================================
+std::optional<NexusLambdaKernel> NexusLambdaKernel::compile(
+	std::vector<NexusLambdaInstruction> const& program,
+	ExchangePtr const exchange)
+{
+	if (!exchange || program.empty()) return std::nullopt;
+
+	NexusLambdaKernel kernel;
+	kernel.program.reserve(program.size());
+	for (auto const& instruction : program)
+	{
+		auto resolved = instruction;
+		if (resolved.opcode == NexusLambdaOpcode::FILTER) {
+			resolved.stats = std::make_shared<NexusFilterStats>();
+		}
+		else {
+			auto column_index = exchange->get_column_index(resolved.column);
+			if (column_index.is_exception()) return std::nullopt;
+			resolved.column_index = column_index.unwrap();
+			if (resolved.window.has_value()) {
+				resolved.rolling = std::make_shared<NexusRollingWindow>(
+					resolved.window.value(),
+					resolved.column_index,
+					resolved.period,
+					exchange,
+					resolved.row
+				);
+			}
+		}
+		kernel.program.push_back(std::move(resolved));
+	}
+
+	// split the program into segments at each INIT. Only the last segment produces the value, the others can
+	// only turn it into nan through a filter or a feature the asset is missing, so none of them is dead. Their
+	// order is free: hoist the ones with filters so filtered assets skip the loads of the rest. A leading
+	// segment without an INIT builds on the initial 0.0 and has to stay first.
+	std::vector<std::vector<NexusLambdaInstruction>> segments;
+	for (auto& instruction : kernel.program)
+	{
+		if (segments.empty() || instruction.opcode == NexusLambdaOpcode::INIT) segments.emplace_back();
+		segments.back().push_back(std::move(instruction));
+	}
+	if (segments.size() > 2) {
+		auto first = segments.begin();
+		if (first->front().opcode != NexusLambdaOpcode::INIT) ++first;
+		std::stable_partition(first, std::prev(segments.end()), [](auto const& segment) {
+			return std::any_of(segment.begin(), segment.end(), [](auto const& i) {
+				return i.opcode == NexusLambdaOpcode::FILTER;
+			});
+		});
+	}
+	kernel.program.clear();
+	for (auto& segment : segments)
+	{
+		std::move(segment.begin(), segment.end(), std::back_inserter(kernel.program));
+	}
+
+	// chain the instruction hashes so equal prefixes of different kernels share feature cache entries
+	size_t seed = 0;
+	auto combine = [&seed](size_t value) {
+		seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+	};
+	kernel.prefix_hashes.reserve(kernel.program.size());
+	for (auto const& instruction : kernel.program)
+	{
+		combine(static_cast<size_t>(instruction.opcode));
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) {
+			combine(std::hash<double>{}(instruction.lower));
+			combine(std::hash<double>{}(instruction.upper));
+			combine(instruction.lower_inclusive);
+			combine(instruction.upper_inclusive);
+		}
+		else {
+			combine(instruction.column_index);
+			combine(std::hash<int>{}(instruction.row));
+			if (instruction.window.has_value()) {
+				combine(static_cast<size_t>(instruction.window.value()) + 1);
+				combine(std::hash<int>{}(instruction.period));
+			}
+		}
+		kernel.prefix_hashes.push_back(seed);
+	}
+
+	// a kernel resuming from a cached prefix would never load the windows inside it and their state would lag
+	auto first_rolling = std::find_if(kernel.program.begin(), kernel.program.end(), [](auto const& i) {
+		return i.rolling != nullptr;
+	});
+	kernel.shared = static_cast<size_t>(std::distance(kernel.program.begin(), first_rolling));
+	return kernel;
+}
+
+
+//============================================================================
+size_t NexusLambdaKernel::feature_key(size_t i, int warmup) const
+{
+	size_t seed = this->prefix_hashes[i];
+	seed ^= std::hash<int>{}(warmup) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+	return seed;
+}
+
+
+//============================================================================
+std::vector<size_t> NexusLambdaKernel::feature_keys(int warmup) const
+{
+	std::vector<size_t> keys(this->shared);
+	for (size_t i = 0; i < keys.size(); i++) keys[i] = this->feature_key(i, warmup);
+	return keys;
+}
+
+
+//============================================================================
+double NexusLambdaKernel::evaluate(AssetPtr const& asset, bool count_filters) const
+{
+	double a = 0.0;
+	for (auto const& instruction : this->program)
+	{
+		// nan from the arithmetic (0/0, inf - inf) stays nan like in the vector path, INIT would discard it
+		if (std::isnan(a)) return a;
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) {
+			bool in_range = (instruction.lower_inclusive ? a >= instruction.lower : a > instruction.lower)
+				&& (instruction.upper_inclusive ? a <= instruction.upper : a < instruction.upper);
+			if (count_filters) {
+				instruction.stats->evaluated.fetch_add(1, std::memory_order_relaxed);
+				instruction.stats->eliminated.fetch_add(!in_range, std::memory_order_relaxed);
+			}
+			if (!in_range) return std::numeric_limits<double>::quiet_NaN();
+			continue;
+		}
+		if (instruction.opcode == NexusLambdaOpcode::IDENTITY) continue;
+
+		double b = instruction.rolling
+			? instruction.rolling->value(asset)
+			: nexus_unwrap_feature(asset->get_asset_feature(instruction.column_index, instruction.row));
+		if (std::isnan(b)) return b;
+		a = apply_opcode(instruction.opcode, a, b);
+	}
+	return a;
+}
+
+
+//============================================================================
+void NexusLambdaKernel::evaluate(
+	std::vector<AssetPtr> const& assets,
+	std::vector<double>& out,
+	std::vector<double>& feature) const
+{
+	out.assign(assets.size(), 0.0);
+	for (size_t i = 0; i < this->program.size(); i++)
+	{
+		this->evaluate_instruction(i, assets, out, feature);
+	}
+}
+
+
+//============================================================================
+void NexusLambdaKernel::evaluate_instruction(
+	size_t i,
+	std::vector<AssetPtr> const& assets,
+	std::vector<double>& out,
+	std::vector<double>& feature) const
+{
+	auto const& instruction = this->program[i];
+	size_t n = assets.size();
+	feature.resize(n);
+	double* a = out.data();
+	double const* b = feature.data();
+
+	// filtered assets become nan and stay nan for the rest of the program
+	if (instruction.opcode == NexusLambdaOpcode::FILTER) {
+		double lower = instruction.lower;
+		double upper = instruction.upper;
+		bool lower_inclusive = instruction.lower_inclusive;
+		bool upper_inclusive = instruction.upper_inclusive;
+		size_t evaluated = 0, eliminated = 0;
+		for (size_t j = 0; j < n; j++)
+		{
+			bool in_range = (lower_inclusive ? a[j] >= lower : a[j] > lower)
+				&& (upper_inclusive ? a[j] <= upper : a[j] < upper);
+			evaluated += !std::isnan(a[j]);
+			eliminated += !std::isnan(a[j]) && !in_range;
+			a[j] = in_range ? a[j] : std::numeric_limits<double>::quiet_NaN();
+		}
+		instruction.stats->evaluated.fetch_add(evaluated, std::memory_order_relaxed);
+		instruction.stats->eliminated.fetch_add(eliminated, std::memory_order_relaxed);
+		return;
+	}
+	if (instruction.opcode == NexusLambdaOpcode::IDENTITY) return;
+
+	// gather the feature for the whole universe into a contiguous buffer. Every opcode keeps nan, so assets
+	// that are already filtered out or missing a feature skip the load
+	constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+	if (instruction.rolling) {
+		for (size_t j = 0; j < n; j++) feature[j] = std::isnan(a[j]) ? nan : instruction.rolling->value(assets[j]);
+	}
+	else {
+		for (size_t j = 0; j < n; j++)
+		{
+			feature[j] = std::isnan(a[j]) ? nan : nexus_load_feature(assets[j], instruction.column_index, instruction.row);
+		}
+	}
+
+	// apply the opcode in a single pass, the switch is hoisted out of the loop so each case vectorizes
+	switch (instruction.opcode)
+	{
+		case NexusLambdaOpcode::INIT:
+			for (size_t j = 0; j < n; j++) a[j] = std::isnan(a[j]) ? a[j] : b[j];
+			break;
+		case NexusLambdaOpcode::ADD:
+			for (size_t j = 0; j < n; j++) a[j] += b[j];
+			break;
+		case NexusLambdaOpcode::SUBTRACT:
+			for (size_t j = 0; j < n; j++) a[j] -= b[j];
+			break;
+		case NexusLambdaOpcode::MULTIPLY:
+			for (size_t j = 0; j < n; j++) a[j] *= b[j];
+			break;
+		case NexusLambdaOpcode::DIVIDE:
+			for (size_t j = 0; j < n; j++) a[j] /= b[j];
+			break;
+		default:
+			break;
+	}
+}
+
+
+//============================================================================
+std::vector<std::tuple<std::string, size_t, size_t>> NexusLambdaKernel::filter_stats() const
+{
+	std::vector<std::tuple<std::string, size_t, size_t>> stats;
+	for (auto const& instruction : this->program)
+	{
+		if (instruction.opcode != NexusLambdaOpcode::FILTER) continue;
+		stats.emplace_back(
+			nexus_filter_string(instruction),
+			instruction.stats->evaluated.load(std::memory_order_relaxed),
+			instruction.stats->eliminated.load(std::memory_order_relaxed)
+		);
+	}
+	return stats;
+}
+
+
+//============================================================================
+void NexusCrossSection::layout(ExchangePtr const exchange)
+{
+	auto const& exchange_assets = exchange->get_assets();
+	size_t lowest = std::numeric_limits<size_t>::max();
+	size_t highest = 0;
+	for (auto const& asset : exchange_assets)
+	{
+		if (!asset) continue;
+		lowest = std::min(lowest, asset->get_asset_index());
+		highest = std::max(highest, asset->get_asset_index());
+	}
+	this->assets.clear();
+	if (lowest > highest) return;
+
+	// lay the universe out by asset index so lookups don't need a map, non streaming slots stay null
+	this->base = lowest;
+	this->assets.resize(highest - lowest + 1, nullptr);
+	for (auto const& asset : exchange_assets)
+	{
+		if (!asset || !asset->__is_streaming) continue;
+		this->assets[asset->get_asset_index() - this->base] = asset;
+	}
+}
+
+
+//============================================================================
+void NexusCrossSection::activate(NexusLambdaKernel const& kernel, ExchangePtr const exchange, int warmup)
+{
+	this->layout(exchange);
+	this->active.clear();
+	this->active_slots.clear();
+	if (this->assets.empty()) return;
+
+	// any load of the kernel can probe for history, the rows are shared by every column
+	size_t column_index = 0;
+	for (auto const& instruction : kernel.instructions())
+	{
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) continue;
+		column_index = instruction.column_index;
+		break;
+	}
+	auto bitmap = NexusAvailability::instance().get(
+		exchange.get(),
+		exchange->get_datetime(),
+		this->assets,
+		column_index,
+		warmup
+	);
+
+	// only the set bits are evaluated, walk the words so empty stretches of the universe are skipped
+	auto const& bits = *bitmap;
+	for (size_t w = 0; w < bits.size(); w++)
+	{
+		uint64_t word = bits[w];
+		while (word)
+		{
+			size_t slot = (w << 6) + std::countr_zero(word);
+			word &= word - 1;
+			this->active.push_back(this->assets[slot]);
+			this->active_slots.push_back(slot);
+		}
+	}
+}
+
+
+//============================================================================
+void NexusCrossSection::scatter(std::vector<double> const& dense)
+{
+	this->values.assign(this->assets.size(), std::numeric_limits<double>::quiet_NaN());
+	for (size_t j = 0; j < this->active_slots.size(); j++)
+	{
+		this->values[this->active_slots[j]] = dense[j];
+	}
+}
+
+
+//============================================================================
+void NexusCrossSection::evaluate(NexusLambdaKernel const& kernel, ExchangePtr const exchange, int warmup, NexusFeatureCache* feature_cache)
+{
+	this->activate(kernel, exchange, warmup);
+	if (this->active.empty()) {
+		this->values.assign(this->assets.size(), std::numeric_limits<double>::quiet_NaN());
+		return;
+	}
+
+	// resume from the longest prefix another strategy already evaluated this bar. A hit on the whole kernel is
+	// scattered straight from the shared buffer, a shorter one is copied once as the rest of the kernel
+	// writes to it
+	auto& cache = feature_cache ? *feature_cache : NexusFeatureCache::instance();
+	auto datetime = exchange->get_datetime();
+	size_t start = 0;
+	for (size_t k = kernel.shared_size(); k > 0; k--)
+	{
+		auto key = kernel.feature_key(k - 1, warmup);
+		if (!cache.is_shared(key)) continue;
+		auto buffer = cache.get(exchange.get(), datetime, key);
+		if (!buffer || buffer->size() != this->active.size()) continue;
+		if (k == kernel.size()) {
+			this->scatter(*buffer);
+			return;
+		}
+		this->dense = *buffer;
+		start = k;
+		break;
+	}
+	if (start == 0) this->dense.assign(this->active.size(), 0.0);
+
+	// only prefixes another live kernel starts with are worth the copy into the cache
+	for (size_t i = start; i < kernel.size(); i++)
+	{
+		kernel.evaluate_instruction(i, this->active, this->dense, this->feature);
+		if (i >= kernel.shared_size()) continue;
+		auto key = kernel.feature_key(i, warmup);
+		if (cache.is_shared(key)) cache.put(exchange.get(), datetime, key, this->dense);
+	}
+	this->scatter(this->dense);
+}
+
+
+#ifdef USE_LUAJIT
+//============================================================================
+void NexusCrossSection::evaluate(NexusLuaKernel& kernel, NexusLambdaKernel const& source, ExchangePtr const exchange, int warmup)
+{
+	this->activate(source, exchange, warmup);
+	kernel.evaluate(this->active, this->dense);
+	this->scatter(this->dense);
+}
+#endif
+
+
+//============================================================================
+void NexusCrossSection::evaluate(NexusNativeKernel const& kernel, NexusLambdaKernel const& source, ExchangePtr const exchange, int warmup)
+{
+	this->activate(source, exchange, warmup);
+	this->dense.resize(this->active.size());
+	kernel.function(this->active.data(), this->active.size(), this->dense.data());
+	this->scatter(this->dense);
+}
+
+
+//============================================================================
+double NexusCrossSection::lookup(AssetPtr const& asset) const
+{
+	size_t index = asset->get_asset_index();
+	if (index < this->base || index - this->base >= this->values.size()) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+	return this->values[index - this->base];
+}
@@ -0,0 +1,85 @@
+#include "NexusLibrary.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+
+#ifdef _WIN32
+const std::string nexus_library_extension = ".dll";
+#else
+const std::string nexus_library_extension = ".so";
+#endif
+
+
+//============================================================================
+NexusLibraryHandle nexus_library_open(fs::path const& path)
+{
+	// a bare file name would be looked up on the library search path instead of next to the working directory
+	auto absolute_path = fs::absolute(path);
+#ifdef _WIN32
+	return reinterpret_cast<NexusLibraryHandle>(LoadLibraryW(absolute_path.wstring().c_str()));
+#else
+	// resolve everything up front so a missing symbol fails the load instead of the first call
+	return dlopen(absolute_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+
+//============================================================================
+void* nexus_library_symbol(NexusLibraryHandle library, char const* name)
+{
+#ifdef _WIN32
+	return reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(library), name));
+#else
+	return dlsym(library, name);
+#endif
+}
+
+
+//============================================================================
+void nexus_library_close(NexusLibraryHandle library)
+{
+	if (!library) return;
+#ifdef _WIN32
+	FreeLibrary(reinterpret_cast<HMODULE>(library));
+#else
+	dlclose(library);
+#endif
+}
+
+
+//============================================================================
+std::string nexus_library_error()
+{
+#ifdef _WIN32
+	DWORD code = GetLastError();
+	if (code == 0) return std::string();
+	LPSTR buffer = nullptr;
+	DWORD size = FormatMessageA(
+		FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+		nullptr, code, 0, reinterpret_cast<LPSTR>(&buffer), 0, nullptr
+	);
+	std::string msg = size ? std::string(buffer, size) : "error code " + std::to_string(code);
+	LocalFree(buffer);
+	while (!msg.empty() && (msg.back() == '\n' || msg.back() == '\r')) msg.pop_back();
+	return msg;
+#else
+	char const* msg = dlerror();
+	return msg ? std::string(msg) : std::string();
+#endif
+}
+
+
+//============================================================================
+void nexus_library_set_directory(fs::path const& folder)
+{
+#ifdef _WIN32
+	SetDllDirectoryW(folder.empty() ? nullptr : fs::absolute(folder).wstring().c_str());
+#else
+	(void)folder;
+#endif
+}
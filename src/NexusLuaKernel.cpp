@@ -0,0 +1,154 @@
+#ifdef USE_LUAJIT
+#include "NexusLuaKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+
+
+//============================================================================
+static std::string lua_number(double x)
+{
+	if (std::isinf(x)) return x > 0 ? "math.huge" : "-math.huge";
+	std::ostringstream oss;
+	oss.precision(17);
+	oss << x;
+	return "(" + oss.str() + ")";
+}
+
+
+//============================================================================
+static double nexus_lua_load_feature(void* assets, uint64_t j, uint64_t column_index, int32_t row)
+{
+	// called from the jitted loop through an ffi function pointer, nexus_load_feature never throws
+	auto const& asset = static_cast<AssetPtr const*>(assets)[j];
+	return nexus_load_feature(asset, static_cast<size_t>(column_index), static_cast<int>(row));
+}
+
+
+//============================================================================
+std::string nexus_lua_codegen(NexusLambdaKernel const& kernel)
+{
+	std::vector<std::pair<size_t, int>> loads;
+	size_t filters = 0;
+
+	// every instruction leaves a valid or breaks out with a = nan, so the rest of the chain is skipped
+	std::ostringstream body;
+	for (auto const& instruction : kernel.instructions())
+	{
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) {
+			size_t k = filters++;
+			body << "\t\t\tstats[" << 2 * k << "] = stats[" << 2 * k << "] + 1\n";
+			body << "\t\t\tif not (a " << (instruction.lower_inclusive ? ">=" : ">") << " " << lua_number(instruction.lower)
+				<< " and a " << (instruction.upper_inclusive ? "<=" : "<") << " " << lua_number(instruction.upper)
+				<< ") then stats[" << 2 * k + 1 << "] = stats[" << 2 * k + 1 << "] + 1; a = nan; break end\n";
+			continue;
+		}
+		if (instruction.opcode == NexusLambdaOpcode::IDENTITY) continue;
+
+		// identical loads are read once per asset, a later use already knows the value is not nan
+		auto key = std::make_pair(instruction.column_index, instruction.row);
+		auto it = std::find(loads.begin(), loads.end(), key);
+		std::string b = "f" + std::to_string(std::distance(loads.begin(), it));
+		if (it == loads.end()) {
+			loads.push_back(key);
+			body << "\t\t\tlocal " << b << " = load(assets, i, " << instruction.column_index << ", " << instruction.row << ")\n";
+			body << "\t\t\tif " << b << " ~= " << b << " then a = nan; break end\n";
+		}
+		switch (instruction.opcode)
+		{
+			case NexusLambdaOpcode::INIT: body << "\t\t\ta = " << b << "\n"; continue;
+			case NexusLambdaOpcode::ADD: body << "\t\t\ta = a + " << b << "\n"; break;
+			case NexusLambdaOpcode::SUBTRACT: body << "\t\t\ta = a - " << b << "\n"; break;
+			case NexusLambdaOpcode::MULTIPLY: body << "\t\t\ta = a * " << b << "\n"; break;
+			case NexusLambdaOpcode::DIVIDE: body << "\t\t\ta = a / " << b << "\n"; break;
+			default: continue;
+		}
+		// 0 / 0 and inf - inf end the chain like a missing feature
+		body << "\t\t\tif a ~= a then break end\n";
+	}
+
+	std::ostringstream source;
+	source << "local ffi = require(\"ffi\")\n";
+	source << "return function(out_ptr, assets, load_ptr, stats_ptr, n)\n";
+	source << "\tlocal out = ffi.cast(\"double*\", out_ptr)\n";
+	source << "\tlocal load = ffi.cast(\"double (*)(void*, uint64_t, uint64_t, int32_t)\", load_ptr)\n";
+	source << "\tlocal stats = ffi.cast(\"uint64_t*\", stats_ptr)\n";
+	source << "\tlocal nan = 0 / 0\n";
+	source << "\tfor i = 0, n - 1 do\n";
+	source << "\t\tlocal a = 0.0\n";
+	source << "\t\trepeat\n";
+	source << body.str();
+	source << "\t\tuntil true\n";
+	source << "\t\tout[i] = a\n";
+	source << "\tend\n";
+	source << "end\n";
+	return source.str();
+}
+
+
+//============================================================================
+std::shared_ptr<NexusLuaKernel> NexusLuaKernel::compile(NexusLambdaKernel const& kernel)
+{
+	// rolling windows keep per asset state in C++, leave those kernels to NexusLambdaKernel
+	for (auto const& instruction : kernel.instructions())
+	{
+		if (instruction.rolling) return nullptr;
+	}
+
+	std::shared_ptr<NexusLuaKernel> lua_kernel(new NexusLuaKernel());
+	lua_kernel->source = nexus_lua_codegen(kernel);
+	lua_kernel->lua.open_libraries(
+		sol::lib::base,
+		sol::lib::package,
+		sol::lib::math,
+		sol::lib::ffi,
+		sol::lib::jit
+	);
+
+	auto result = lua_kernel->lua.safe_script(lua_kernel->source, sol::script_pass_on_error);
+	if (!result.valid()) return nullptr;
+	sol::object function = result;
+	if (function.get_type() != sol::type::function) return nullptr;
+	lua_kernel->function = function.as<sol::protected_function>();
+
+	// the counts of the jitted loop are added to the filters of the source kernel, so its filter_stats cover both
+	for (auto const& instruction : kernel.instructions())
+	{
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) lua_kernel->filters.push_back(instruction.stats);
+	}
+	lua_kernel->counts.resize(2 * lua_kernel->filters.size());
+	return lua_kernel;
+}
+
+
+//============================================================================
+void NexusLuaKernel::evaluate(std::vector<AssetPtr> const& assets, std::vector<double>& out)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	size_t n = assets.size();
+	out.assign(n, std::numeric_limits<double>::quiet_NaN());
+	if (n == 0) return;
+
+	std::fill(this->counts.begin(), this->counts.end(), 0);
+	auto res = this->function(
+		static_cast<void*>(out.data()),
+		const_cast<void*>(static_cast<void const*>(assets.data())),
+		reinterpret_cast<void*>(&nexus_lua_load_feature),
+		static_cast<void*>(this->counts.data()),
+		static_cast<double>(n)
+	);
+	if (!res.valid()) {
+		sol::error err = res;
+		throw std::runtime_error(std::string("LuaJIT kernel failed: ") + err.what());
+	}
+	for (size_t k = 0; k < this->filters.size(); k++)
+	{
+		this->filters[k]->evaluated.fetch_add(this->counts[2 * k], std::memory_order_relaxed);
+		this->filters[k]->eliminated.fetch_add(this->counts[2 * k + 1], std::memory_order_relaxed);
+	}
+}
+
+#endif
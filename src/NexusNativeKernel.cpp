@@ -0,0 +1,297 @@
+#include "NexusNativeKernel.h"
+
+#include <cctype>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+
+#include "NexusCodeGen.h"
+
+
+const std::string nexus_native_header = R"(// generated by Nexus, building blocks of the native flow strategy kernels.
+// ANY CHANGES WILL BE OVERWRITEN ON THE NEXT COMPILE
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "AgisEnums.h"
+#include "Asset/Asset.h"
+
+namespace Agis {}
+
+namespace nexus_kernel {
+
+using namespace Agis;
+
+constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+// features are either returned directly or wrapped in an AgisResult
+template <typename T>
+inline double unwrap(T&& feature)
+{
+    if constexpr (std::is_arithmetic_v<std::decay_t<T>>) return static_cast<double>(feature);
+    else return feature.is_exception() ? nan : feature.unwrap();
+}
+
+// column[row] of an asset, nan if the feature is unavailable
+template <size_t Column, int Row>
+struct Load
+{
+    static double apply(AssetPtr const& asset) { return unwrap(asset->get_asset_feature(Column, Row)); }
+};
+
+struct Init { static double apply(double, double b) noexcept { return b; } };
+struct Add { static double apply(double a, double b) noexcept { return a + b; } };
+struct Subtract { static double apply(double a, double b) noexcept { return a - b; } };
+struct Multiply { static double apply(double a, double b) noexcept { return a * b; } };
+struct Divide { static double apply(double a, double b) noexcept { return a / b; } };
+
+// apply an operation to the running value and a load, nan stays nan so filtered assets skip the load
+template <class Op, class L>
+inline double step(double a, AssetPtr const& asset)
+{
+    if (std::isnan(a)) return a;
+    return Op::apply(a, L::apply(asset));
+}
+
+// exclude the asset if the running value is outside of the range
+template <class Range>
+inline double filter(double a) noexcept
+{
+    bool above = Range::lower_inclusive ? a >= Range::lower : a > Range::lower;
+    bool below = Range::upper_inclusive ? a <= Range::upper : a < Range::upper;
+    return above && below ? a : nan;
+}
+
+// mask every value that can't be part of the query result, the engine only orders what is left
+template <ExchangeQueryType Query, int N>
+inline void select(double* values, size_t count)
+{
+    if constexpr (Query != ExchangeQueryType::NLargest && Query != ExchangeQueryType::NSmallest && Query != ExchangeQueryType::NExtreme) {
+        return;
+    }
+    else if constexpr (N >= 0) {
+        constexpr size_t n = static_cast<size_t>(N);
+        static thread_local std::vector<std::pair<double, size_t>> candidates;
+        candidates.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!std::isfinite(values[i])) values[i] = nan;
+            else candidates.emplace_back(values[i], i);
+        }
+        auto begin = candidates.begin();
+        auto end = candidates.end();
+        auto by_value = [](auto const& a, auto const& b) { return a.first < b.first; };
+        if constexpr (Query == ExchangeQueryType::NExtreme) {
+            if (candidates.size() <= 2 * n) return;
+            std::nth_element(begin, begin + n, end, by_value);
+            std::nth_element(begin + n, end - n, end, by_value);
+            for (auto it = begin + n; it != end - n; ++it) values[it->second] = nan;
+        }
+        else {
+            if (candidates.size() <= n) return;
+            if constexpr (Query == ExchangeQueryType::NLargest) {
+                std::nth_element(begin, begin + n, end, [](auto const& a, auto const& b) { return a.first > b.first; });
+            }
+            else {
+                std::nth_element(begin, begin + n, end, by_value);
+            }
+            for (auto it = begin + n; it != end; ++it) values[it->second] = nan;
+        }
+    }
+}
+
+}
+)";
+
+
+//============================================================================
+static std::string cpp_number(double x)
+{
+	if (std::isinf(x)) return x > 0 ? "inf" : "-inf";
+	std::ostringstream oss;
+	oss.precision(17);
+	oss << x;
+	return oss.str();
+}
+
+
+//============================================================================
+static std::string query_string(ExchangeQueryType query_type)
+{
+	switch (query_type)
+	{
+		case ExchangeQueryType::Default: return "ExchangeQueryType::Default";
+		case ExchangeQueryType::NLargest: return "ExchangeQueryType::NLargest";
+		case ExchangeQueryType::NSmallest: return "ExchangeQueryType::NSmallest";
+		case ExchangeQueryType::NExtreme: return "ExchangeQueryType::NExtreme";
+		default: return "static_cast<ExchangeQueryType>(" + std::to_string(static_cast<int>(query_type)) + ")";
+	}
+}
+
+
+//============================================================================
+bool nexus_native_supported(NexusLambdaKernel const& kernel)
+{
+	if (kernel.size() == 0) return false;
+	for (auto const& instruction : kernel.instructions())
+	{
+		if (instruction.rolling || instruction.window.has_value()) return false;
+	}
+	return true;
+}
+
+
+//============================================================================
+uint64_t nexus_native_hash(NexusLambdaKernel const& kernel, ExchangeQueryType query_type, int N)
+{
+	// hex floats so the bounds hash exactly, the same on every build of Nexus
+	std::ostringstream signature;
+	signature << std::hexfloat;
+	for (auto const& instruction : kernel.instructions())
+	{
+		signature << static_cast<int>(instruction.opcode) << ":";
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) {
+			signature << instruction.lower << "," << instruction.upper << ","
+				<< instruction.lower_inclusive << instruction.upper_inclusive << ";";
+		}
+		else {
+			signature << instruction.column_index << "," << instruction.row << ";";
+		}
+	}
+	signature << "query:" << static_cast<int>(query_type) << "," << N;
+	return nexus_content_hash(signature.str());
+}
+
+
+//============================================================================
+std::string nexus_native_symbol(std::string const& strategy_id)
+{
+	std::string symbol = "nexus_kernel_";
+	for (unsigned char c : strategy_id)
+	{
+		symbol += std::isalnum(c) ? static_cast<char>(c) : '_';
+	}
+	return symbol;
+}
+
+
+//============================================================================
+std::string nexus_native_codegen(
+	NexusLambdaKernel const& kernel,
+	std::string const& strategy_id,
+	ExchangeQueryType query_type,
+	int N)
+{
+	std::ostringstream ranges;
+	std::ostringstream body;
+	size_t filter_count = 0;
+	for (auto const& instruction : kernel.instructions())
+	{
+		if (instruction.opcode == NexusLambdaOpcode::FILTER) {
+			auto range = "Range" + std::to_string(filter_count++);
+			ranges << "struct " << range << "\n{\n"
+				<< "    static constexpr double lower = " << cpp_number(instruction.lower) << ";\n"
+				<< "    static constexpr double upper = " << cpp_number(instruction.upper) << ";\n"
+				<< "    static constexpr bool lower_inclusive = " << (instruction.lower_inclusive ? "true" : "false") << ";\n"
+				<< "    static constexpr bool upper_inclusive = " << (instruction.upper_inclusive ? "true" : "false") << ";\n"
+				<< "};\n\n";
+			body << "    a = filter<" << range << ">(a);\t// " << nexus_filter_string(instruction) << "\n";
+			continue;
+		}
+		if (instruction.opcode == NexusLambdaOpcode::IDENTITY) continue;
+
+		std::string op;
+		switch (instruction.opcode)
+		{
+			case NexusLambdaOpcode::INIT: op = "Init"; break;
+			case NexusLambdaOpcode::ADD: op = "Add"; break;
+			case NexusLambdaOpcode::SUBTRACT: op = "Subtract"; break;
+			case NexusLambdaOpcode::MULTIPLY: op = "Multiply"; break;
+			case NexusLambdaOpcode::DIVIDE: op = "Divide"; break;
+			default: continue;
+		}
+		body << "    a = step<" << op << ", Load<" << instruction.column_index << ", " << instruction.row << ">>(a, asset);\t// "
+			<< instruction.column << "[" << instruction.row << "]\n";
+	}
+
+	auto symbol = nexus_native_symbol(strategy_id);
+	std::ostringstream source;
+	source << "// generated by Nexus from the flow graph of " << strategy_id << ", the asset lambda chain and exchange view\n"
+		<< "// specialized into native code. ANY CHANGES WILL BE OVERWRITEN ON THE NEXT COMPILE\n"
+		<< "#include \"pch.h\"\n"
+		<< "#include \"nexus_kernel.h\"\n\n"
+		<< "namespace {\n\n"
+		<< "using namespace nexus_kernel;\n\n"
+		<< ranges.str()
+		<< "constexpr ExchangeQueryType query_type = " << query_string(query_type) << ";\n"
+		<< "constexpr int N = " << N << ";\n\n"
+		<< "inline double evaluate(AssetPtr const& asset)\n{\n"
+		<< "    double a = 0.0;\n"
+		<< body.str()
+		<< "    return a;\n"
+		<< "}\n\n"
+		<< "}\n\n\n"
+		<< "extern \"C\" AGIS_STRATEGY_API void " << symbol << "(AssetPtr const* assets, size_t count, double* out)\n{\n"
+		<< "    for (size_t i = 0; i < count; i++) out[i] = assets[i] ? evaluate(assets[i]) : nexus_kernel::nan;\n"
+		<< "    select<query_type, N>(out, count);\n"
+		<< "}\n\n\n"
+		<< "extern \"C\" AGIS_STRATEGY_API uint64_t " << symbol << "_hash()\n{\n"
+		<< "    return " << nexus_native_hash(kernel, query_type, N) << "ull;\n"
+		<< "}\n";
+	return source.str();
+}
+
+
+//============================================================================
+NexusNativeKernels& NexusNativeKernels::instance()
+{
+	static NexusNativeKernels kernels;
+	return kernels;
+}
+
+
+//============================================================================
+void NexusNativeKernels::set(
+	std::string const& strategy_id,
+	uint64_t hash,
+	NexusNativeKernelFunction function,
+	std::shared_ptr<void const> owner)
+{
+	std::unique_lock lock(this->mutex);
+	this->strategies[strategy_id] = { hash, NexusNativeKernel{ function, std::move(owner) } };
+}
+
+
+//============================================================================
+std::optional<NexusNativeKernel> NexusNativeKernels::get(uint64_t hash) const
+{
+	// strategies with the same graph share a hash, any of their kernels will do
+	std::shared_lock lock(this->mutex);
+	for (auto const& [strategy_id, entry] : this->strategies)
+	{
+		if (entry.first == hash) return entry.second;
+	}
+	return std::nullopt;
+}
+
+
+//============================================================================
+void NexusNativeKernels::release(std::shared_ptr<void const> const& owner)
+{
+	std::unique_lock lock(this->mutex);
+	std::erase_if(this->strategies, [&owner](auto const& entry) { return entry.second.second.owner == owner; });
+}
+
+
+//============================================================================
+void NexusNativeKernels::clear()
+{
+	std::unique_lock lock(this->mutex);
+	this->strategies.clear();
+}
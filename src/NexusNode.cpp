@@ -15,6 +15,7 @@
 #include "NexusNodeModel.h"
 #include "NexusEnv.h"
 #include "NexusNode.h"
+#include "NexusPreview.h"
 
 #include "ui_NexusNodeEditor.h"
 #include <qlabel.h>
@@ -35,6 +36,9 @@ std::shared_ptr<NodeDelegateModelRegistry> registerDataModels()
 	ret->registerModel<ExchangeModel>();
 	ret->registerModel<ExchangeViewModel>();
 	ret->registerModel<AssetLambdaModel>();
+	ret->registerModel<AssetWindowModel>();
+	ret->registerModel<ExchangeViewTransformModel>();
+	ret->registerModel<PortfolioOptimizerModel>();
 	ret->registerModel<TradeExitModel>();
 	ret->registerModel<StrategyAllocationModel>();
 
@@ -71,10 +75,80 @@ QMenuBar* NexusNodeEditor::createSaveRestoreMenu(BasicGraphicsScene* scene)
 		}
 		});
 
+	// A/B the interpreted asset lambda chains against the compiled kernels on the current exchange
+	QMenu* tools_menu = menuBar->addMenu("Tools");
+	auto benchmarkAction = tools_menu->addAction("Benchmark Lambda Kernel");
+	QObject::connect(benchmarkAction, &QAction::triggered, scene, [this] {
+		RUN_WITH_ERROR_DIALOG(this->__benchmark_kernels());
+		});
+
 	return menuBar;
 }
 
 
+//============================================================================
+void NexusNodeEditor::__benchmark_kernels()
+{
+	constexpr size_t iterations = 100;
+	QString message;
+	for (auto& id : this->dataFlowGraphModel->allNodeIds())
+	{
+		auto node = this->dataFlowGraphModel->delegateModel<ExchangeViewModel>(id);
+		if (!node) continue;
+		auto res = node->benchmark_kernel(iterations);
+		if (!res.has_value()) {
+			message += "Node " + QString::number(id) + ": chain could not be compiled\n";
+			continue;
+		}
+		auto& b = res.value();
+		message += "Node " + QString::number(id) + ": interpreted "
+			+ QString::number(b.interpreted_ms / b.iterations, 'f', 3) + " ms, compiled "
+			+ QString::number(b.compiled_ms / b.iterations, 'f', 3) + " ms, cross sectional "
+			+ QString::number(b.cross_sectional_ms / b.iterations, 'f', 3) + " ms, speedup "
+			+ QString::number(b.interpreted_ms / b.compiled_ms, 'f', 2) + "x / "
+			+ QString::number(b.interpreted_ms / b.cross_sectional_ms, 'f', 2) + "x, full sort "
+			+ QString::number(b.sort_ms / b.iterations, 'f', 3) + " ms, selection "
+			+ QString::number(b.selection_ms / b.iterations, 'f', 3) + " ms"
+			+ (b.views_match ? "" : " (VIEW MISMATCH)") + "\n";
+		for (auto const& [range, evaluated, eliminated] : b.filters)
+		{
+			double rate = evaluated ? 100.0 * static_cast<double>(eliminated) / static_cast<double>(evaluated) : 0.0;
+			message += "    filter " + QString::fromStdString(range) + ": eliminated "
+				+ QString::number(eliminated) + " of " + QString::number(evaluated)
+				+ " (" + QString::number(rate, 'f', 1) + "%)\n";
+		}
+	}
+	if (message.isEmpty()) message = "No exchange view nodes found";
+	QMessageBox::information(this, "Lambda Kernel Benchmark", message);
+}
+
+
+//============================================================================
+void NexusNodeEditor::connect_preview()
+{
+	// preview the first exchange view in the graph, copied out on the gui thread
+	this->preview->set_request_source([this]() -> std::optional<NexusPreviewRequest> {
+		for (auto& id : this->dataFlowGraphModel->allNodeIds())
+		{
+			auto node = this->dataFlowGraphModel->delegateModel<ExchangeViewModel>(id);
+			if (node) return node->preview_request();
+		}
+		return std::nullopt;
+	});
+
+	// every node edit emits dataUpdated, edits of an unconnected node never reach the graph signals
+	auto model = this->dataFlowGraphModel;
+	connect(model, &DataFlowGraphModel::nodeCreated, this->preview, [this, model](NodeId const id) {
+		auto node = model->delegateModel<NodeDelegateModel>(id);
+		if (node) connect(node, &NodeDelegateModel::dataUpdated, this->preview, &NexusPreview::schedule);
+		this->preview->schedule();
+	});
+	connect(model, &DataFlowGraphModel::nodeDeleted, this->preview, &NexusPreview::schedule);
+	connect(model, &DataFlowGraphModel::inPortDataWasSet, this->preview, &NexusPreview::schedule);
+	connect(model, &DataFlowGraphModel::connectionDeleted, this->preview, &NexusPreview::schedule);
+}
+
+
 //============================================================================
 void NexusNodeEditor::on_tw_change(int index)
 {
@@ -278,12 +352,17 @@ NexusNodeEditor::NexusNodeEditor(
 	QSpacerItem* spacer = new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Fixed);
 	l->addItem(spacer);
 	this->create_strategy_tab(l);
+	this->preview = new NexusPreview(centralWidget);
+	l->addWidget(this->preview);
 	h->addLayout(l);
 	centralWidget->setLayout(h);
 
 	// set the base hydra instance
 	ExchangeModel::hydra = nexus_env->get_hydra();
 
+	// connect before loading so the nodes of the saved graph are watched as well
+	this->connect_preview();
+
 	// attempt to load existing flow graph if it exists
 	RUN_WITH_ERROR_DIALOG(this->__load(scene);)
 
@@ -415,28 +494,21 @@ std::optional<ExchangeViewLambdaStruct> NexusNodeEditor::__extract_abstract_stra
 		NEXUS_THROW("Attempting to extract strategy with no asset lambdas");
 	}
 
-	auto epsilon = stod(node->strategy_allocation_node->epsilon->text().toStdString());
-	auto target_leverage = stod(node->strategy_allocation_node->target_leverage->text().toStdString());
-	auto clear_missing = node->strategy_allocation_node->clear_missing->isChecked();
-	auto ev_opp_type = node->strategy_allocation_node->ev_opp_type->currentText().toStdString();
-	auto str_alloc_type = node->strategy_allocation_node->alloc_type->currentText().toStdString();
-	std::optional<double> ev_opp_param = std::nullopt;
-	if (node->strategy_allocation_node->ev_opp_param->isEnabled())
+	auto alloc_node = node->strategy_allocation_node;
+	std::optional<std::string> ev_opp_param = std::nullopt;
+	if (alloc_node->ev_opp_param->isEnabled())
 	{
-		auto val = node->strategy_allocation_node->ev_opp_param->text().toStdString();
-		ev_opp_param = stod(val);
+		ev_opp_param = alloc_node->ev_opp_param->text().toStdString();
 	}
-
-	StrategyAllocLambdaStruct _struct{
-		epsilon,
-		target_leverage,
+	auto _struct = nexus_strategy_alloc_struct(
+		alloc_node->epsilon->text().toStdString(),
+		alloc_node->target_leverage->text().toStdString(),
+		alloc_node->clear_missing->isChecked(),
+		alloc_node->alloc_type->currentText().toStdString(),
+		alloc_node->ev_opp_type->currentText().toStdString(),
 		ev_opp_param,
-		node->trade_exit,
-		clear_missing,
-		ev_opp_type,
-		agis_strat_alloc_map.at(str_alloc_type),
-		AllocTypeTarget::LEVERAGE
-	};
+		node->trade_exit
+	);
 	auto ev_lambda_struct = node->ev_lambda_struct;
 	ev_lambda_struct.value().strat_alloc_struct = _struct;
 	return ev_lambda_struct;
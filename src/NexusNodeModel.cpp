@@ -1,9 +1,15 @@
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <QVBoxLayout>
 
 #include "NexusNodeModel.h"
 #include "NexusNodeWidget.h"
 #include "NexusErrors.h"
+#include "NexusFeatureCache.h"
+#include "NexusLuaKernel.h"
+#include "NexusNativeKernel.h"
 
 #include "Asset/Asset.h"
 
@@ -71,6 +77,49 @@ QWidget* AssetLambdaModel::embeddedWidget()
 
 
 
+//============================================================================
+QWidget* AssetWindowModel::embeddedWidget()
+{
+	if (!this->asset_window_node) {
+		this->asset_window_node = new AssetWindowNode(
+			nullptr
+		);
+
+		connect(
+			asset_window_node->window_type,
+			QOverload<int>::of(&QComboBox::currentIndexChanged),
+			this,
+			&AssetWindowModel::on_lambda_change
+		);
+		connect(
+			asset_window_node->period,
+			&QSpinBox::valueChanged,
+			this,
+			&AssetWindowModel::on_lambda_change
+		);
+		connect(
+			asset_window_node->opperation,
+			QOverload<int>::of(&QComboBox::currentIndexChanged),
+			this,
+			&AssetWindowModel::on_lambda_change
+		);
+		connect(
+			asset_window_node->column,
+			&QLineEdit::textChanged,
+			this,
+			&AssetWindowModel::on_lambda_change
+		);
+		connect(
+			asset_window_node->filter,
+			&QLineEdit::textChanged,
+			this,
+			&AssetWindowModel::on_filter_change
+		);
+	}
+	return this->asset_window_node;
+}
+
+
 //============================================================================
 QWidget* ExchangeViewModel::embeddedWidget()
 {
@@ -90,6 +139,18 @@ QWidget* ExchangeViewModel::embeddedWidget()
 			this,
 			&ExchangeViewModel::on_exchange_view_change
 		);
+		connect(
+			exchange_view_node->cross_sectional,
+			&QCheckBox::stateChanged,
+			this,
+			&ExchangeViewModel::on_exchange_view_change
+		);
+		connect(
+			exchange_view_node->luajit,
+			&QCheckBox::stateChanged,
+			this,
+			&ExchangeViewModel::on_exchange_view_change
+		);
 	}
 	return this->exchange_view_node;
 }
@@ -121,6 +182,68 @@ QWidget* TradeExitModel::embeddedWidget()
 }
 
 
+//============================================================================
+QWidget* ExchangeViewTransformModel::embeddedWidget()
+{
+	if (!this->transform_node) {
+		this->transform_node = new ExchangeViewTransformNode(
+			nullptr
+		);
+
+		connect(
+			transform_node->transform_type,
+			QOverload<int>::of(&QComboBox::currentIndexChanged),
+			this,
+			&ExchangeViewTransformModel::on_transform_change
+		);
+		connect(
+			transform_node->param,
+			&QDoubleSpinBox::valueChanged,
+			this,
+			&ExchangeViewTransformModel::on_transform_change
+		);
+	}
+	return this->transform_node;
+}
+
+
+//============================================================================
+QWidget* PortfolioOptimizerModel::embeddedWidget()
+{
+	if (!this->optimizer_node) {
+		this->optimizer_node = new PortfolioOptimizerNode(
+			nullptr
+		);
+
+		connect(
+			optimizer_node->objective,
+			QOverload<int>::of(&QComboBox::currentIndexChanged),
+			this,
+			&PortfolioOptimizerModel::on_optimizer_change
+		);
+		connect(
+			optimizer_node->risk_aversion,
+			&QDoubleSpinBox::valueChanged,
+			this,
+			&PortfolioOptimizerModel::on_optimizer_change
+		);
+		connect(
+			optimizer_node->max_weight,
+			&QDoubleSpinBox::valueChanged,
+			this,
+			&PortfolioOptimizerModel::on_optimizer_change
+		);
+		connect(
+			optimizer_node->long_only,
+			&QCheckBox::stateChanged,
+			this,
+			&PortfolioOptimizerModel::on_optimizer_change
+		);
+	}
+	return this->optimizer_node;
+}
+
+
 //============================================================================
 QWidget* StrategyAllocationModel::embeddedWidget()
 {
@@ -165,6 +288,36 @@ void AssetLambdaModel::on_lambda_change()
 }
 
 
+//============================================================================
+void AssetWindowModel::on_filter_change()
+{
+	auto filter_text = this->asset_window_node->filter->text();
+	if (filter_text.isEmpty()) {
+		this->on_lambda_change();
+		return;
+	};
+
+	auto& last_char = filter_text[filter_text.size() - 1];
+	if (last_char == ')' || last_char == ']') {
+		try {
+			auto filter = AssetFilterRange(filter_text.toStdString());
+			this->asset_window_node->filter->setStyleSheet("QLineEdit { background: white; }");
+			this->on_lambda_change();
+		}
+		catch (std::exception&) {
+			this->asset_window_node->filter->setStyleSheet("QLineEdit { background: red; }");
+		}
+	}
+}
+
+
+//============================================================================
+void AssetWindowModel::on_lambda_change()
+{
+	Q_EMIT dataUpdated(0);
+}
+
+
 //============================================================================
 void ExchangeModel::on_exchange_change()
 {
@@ -180,6 +333,20 @@ void ExchangeViewModel::on_exchange_view_change()
 }
 
 
+//============================================================================
+void ExchangeViewTransformModel::on_transform_change()
+{
+	Q_EMIT dataUpdated(0);
+}
+
+
+//============================================================================
+void PortfolioOptimizerModel::on_optimizer_change()
+{
+	Q_EMIT dataUpdated(0);
+}
+
+
 //============================================================================
 void TradeExitModel::on_exit_change()
 {
@@ -200,6 +367,21 @@ QJsonObject AssetLambdaModel::save() const
 
 
 
+//============================================================================
+QJsonObject AssetWindowModel::save() const
+{
+	QJsonObject modelJson = NodeDelegateModel::save();
+
+	modelJson["window_type"] = this->asset_window_node->window_type->currentText();
+	modelJson["period"] = QString::number(this->asset_window_node->period->value());
+	modelJson["opperation"] = this->asset_window_node->opperation->currentText();
+	modelJson["column"] = this->asset_window_node->column->text();
+	modelJson["filter"] = this->asset_window_node->filter->text();
+	return modelJson;
+}
+
+
+
 //============================================================================
 QJsonObject TradeExitModel::save() const
 {
@@ -217,6 +399,32 @@ QJsonObject ExchangeViewModel::save() const
 	QJsonObject modelJson = NodeDelegateModel::save();
 	modelJson["query_type"] = this->exchange_view_node->query_type->currentText();
 	modelJson["N"] = QString::number(this->exchange_view_node->N->value());
+	modelJson["cross_sectional"] = this->exchange_view_node->cross_sectional->isChecked();
+	modelJson["luajit"] = this->exchange_view_node->luajit->isChecked();
+	return modelJson;
+}
+
+
+
+//============================================================================
+QJsonObject ExchangeViewTransformModel::save() const
+{
+	QJsonObject modelJson = NodeDelegateModel::save();
+	modelJson["transform_type"] = this->transform_node->transform_type->currentText();
+	modelJson["param"] = QString::number(this->transform_node->param->value());
+	return modelJson;
+}
+
+
+
+//============================================================================
+QJsonObject PortfolioOptimizerModel::save() const
+{
+	QJsonObject modelJson = NodeDelegateModel::save();
+	modelJson["objective"] = this->optimizer_node->objective->currentText();
+	modelJson["risk_aversion"] = QString::number(this->optimizer_node->risk_aversion->value());
+	modelJson["max_weight"] = QString::number(this->optimizer_node->max_weight->value());
+	modelJson["long_only"] = this->optimizer_node->long_only->isChecked();
 	return modelJson;
 }
 
@@ -341,11 +549,41 @@ void AssetLambdaModel::load(QJsonObject const& p)
 }
 
 
+//============================================================================
+void AssetWindowModel::load(QJsonObject const& p)
+{
+	QJsonValue window_type = p["window_type"];
+	QJsonValue period = p["period"];
+	QJsonValue opp = p["opperation"];
+	QJsonValue column = p["column"];
+	QJsonValue filter = p["filter"];
+
+	if (!asset_window_node) { this->embeddedWidget(); }
+	if (!window_type.isUndefined()) {
+		asset_window_node->window_type->setCurrentText(window_type.toString());
+	}
+	if (!period.isUndefined()) {
+		asset_window_node->period->setValue(period.toString().toInt());
+	}
+	if (!opp.isUndefined()) {
+		asset_window_node->opperation->setCurrentText(opp.toString());
+	}
+	if (!column.isUndefined()) {
+		asset_window_node->column->setText(column.toString());
+	}
+	if (!filter.isUndefined()) {
+		asset_window_node->filter->setText(filter.toString());
+	}
+}
+
+
 //============================================================================
 void ExchangeViewModel::load(QJsonObject const& p)
 {
 	QJsonValue query_type = p["query_type"];
 	QJsonValue N = p["N"];
+	QJsonValue cross_sectional = p["cross_sectional"];
+	QJsonValue luajit = p["luajit"];
 
 	if (!query_type.isUndefined()) {
 		QString str_opp = query_type.toString();
@@ -362,6 +600,58 @@ void ExchangeViewModel::load(QJsonObject const& p)
 			exchange_view_node->N->setValue(N_num);
 		}
 	}
+	if (!cross_sectional.isUndefined()) {
+		if (exchange_view_node)
+		{
+			exchange_view_node->cross_sectional->setChecked(cross_sectional.toBool());
+		}
+	}
+	if (!luajit.isUndefined()) {
+		if (exchange_view_node)
+		{
+			exchange_view_node->luajit->setChecked(luajit.toBool());
+		}
+	}
+}
+
+
+//============================================================================
+void ExchangeViewTransformModel::load(QJsonObject const& p)
+{
+	QJsonValue transform_type = p["transform_type"];
+	QJsonValue param = p["param"];
+
+	if (!transform_node) { this->embeddedWidget(); }
+	if (!transform_type.isUndefined()) {
+		transform_node->transform_type->setCurrentText(transform_type.toString());
+	}
+	if (!param.isUndefined()) {
+		transform_node->param->setValue(param.toString().toDouble());
+	}
+}
+
+
+//============================================================================
+void PortfolioOptimizerModel::load(QJsonObject const& p)
+{
+	QJsonValue objective = p["objective"];
+	QJsonValue risk_aversion = p["risk_aversion"];
+	QJsonValue max_weight = p["max_weight"];
+	QJsonValue long_only = p["long_only"];
+
+	if (!optimizer_node) { this->embeddedWidget(); }
+	if (!objective.isUndefined()) {
+		optimizer_node->objective->setCurrentText(objective.toString());
+	}
+	if (!risk_aversion.isUndefined()) {
+		optimizer_node->risk_aversion->setValue(risk_aversion.toString().toDouble());
+	}
+	if (!max_weight.isUndefined()) {
+		optimizer_node->max_weight->setValue(max_weight.toString().toDouble());
+	}
+	if (!long_only.isUndefined()) {
+		optimizer_node->long_only->setChecked(long_only.toBool());
+	}
 }
 
 
@@ -405,6 +695,286 @@ void TradeExitModel::load(QJsonObject const& p)
 	}
 }
 
+//============================================================================
+void nexus_push_asset_lambda(
+	AgisAssetLambdaChain& lambda_chain,
+	NexusLambdaProgram& program,
+	std::string const& op_str,
+	std::string const& column_name,
+	int row,
+	std::string const& filter_str)
+{
+	AgisOperation op = agis_function_map.at(op_str);
+	AssetLambda l = AssetLambda(op, [=](const AssetPtr& asset) {
+		return asset->get_asset_feature(column_name, row);
+	});
+	AssetLambdaScruct asset_lambda_struct{ l, op, column_name, row };
+	lambda_chain.push_back(asset_lambda_struct);
+
+	// lower the same operation for the compiled kernel, any element that can't be lowered
+	// disables the kernel for the whole chain
+	auto instruction = nexus_lambda_instruction(op_str, column_name, row);
+	if (program.has_value() && instruction.has_value()) program->push_back(instruction.value());
+	else program = std::nullopt;
+
+	// parse the filter if needed
+	if (!filter_str.empty())
+	{
+		lambda_chain.push_back(AssetLambdaScruct(AssetFilterRange(filter_str)));
+		auto filter = nexus_filter_instruction(filter_str);
+		if (program.has_value() && filter.has_value()) program->push_back(filter.value());
+		else program = std::nullopt;
+	}
+}
+
+
+//============================================================================
+std::optional<AgisAssetLambdaChain> nexus_resolve_lambda_chain(
+	AgisAssetLambdaChain& lambda_chain,
+	ExchangePtr const exchange)
+{
+	if (!exchange) return std::nullopt;
+	AgisAssetLambdaChain resolved_chain;
+	for (AssetLambdaScruct& lambda_struct : lambda_chain)
+	{
+		// if the asset lambda struct is a filter then just push it to the chain
+		if (lambda_struct.is_filter()) {
+			resolved_chain.emplace_back(lambda_struct);
+			continue;
+		}
+
+		// parse column name, if it is invalid return. Needs to be improved
+		auto& operation = lambda_struct.get_asset_operation_struct();
+		auto& column_name = operation.column;
+		auto window_spec = nexus_parse_window_column(column_name);
+		auto column_index_res = exchange->get_column_index(window_spec ? window_spec->column : column_name);
+		if (column_index_res.is_exception()) return std::nullopt;
+
+		// with the new column index create a new asset lambda struct and push to the chain
+		auto column_index = column_index_res.unwrap();
+		auto row = operation.row;
+		AssetLambda lambda_op;
+		if (window_spec.has_value()) {
+			// rolling window elements keep their state in the lambda, the row only carries the warmup
+			auto window = std::make_shared<NexusRollingWindow>(
+				window_spec->type,
+				column_index,
+				window_spec->period,
+				exchange
+			);
+			lambda_op = AssetLambda(operation.asset_lambda.first, [=](const AssetPtr& asset) -> decltype(asset->get_asset_feature(column_index, row)) {
+				return window->value(asset);
+				});
+		}
+		else {
+			lambda_op = AssetLambda(operation.asset_lambda.first, [=](const AssetPtr& asset) {
+				return asset->get_asset_feature(column_index, row);
+				});
+		}
+		AssetLambdaScruct asset_lambda_struct{ lambda_op, operation.asset_lambda.first, column_name, row};
+		resolved_chain.emplace_back(asset_lambda_struct);
+	}
+	return resolved_chain;
+}
+
+
+//============================================================================
+int nexus_lambda_chain_warmup(AgisAssetLambdaChain& lambda_chain)
+{
+	int min_row = 0;
+	for (auto& asset_lambda_struct : lambda_chain)
+	{
+		if (asset_lambda_struct.is_filter()) continue;
+		auto& operation = asset_lambda_struct.get_asset_operation_struct();
+		if (operation.row < min_row) { min_row = operation.row; }
+	}
+	return abs(min_row);
+}
+
+
+//============================================================================
+ExchangeViewLambdaStruct nexus_exchange_view_struct(
+	AgisAssetLambdaChain const& lambda_chain,
+	NexusLambdaProgram const& program,
+	ExchangePtr const exchange,
+	ExchangeQueryType query_type,
+	int N,
+	int warmup,
+	bool cross_sectional,
+	bool luajit)
+{
+	auto warmup_copy = warmup;
+
+	// compile the chain into a flat kernel, fall back to the interpreted chain if it can't be lowered
+	std::shared_ptr<NexusLambdaKernel const> kernel = nullptr;
+	if (program.has_value()) {
+		auto compiled = NexusLambdaKernel::compile(program.value(), exchange);
+		if (compiled.has_value()) kernel = std::make_shared<NexusLambdaKernel const>(std::move(compiled.value()));
+	}
+#ifdef USE_LUAJIT
+	std::shared_ptr<NexusLuaKernel> lua_kernel = nullptr;
+	if (kernel && cross_sectional && luajit) lua_kernel = NexusLuaKernel::compile(*kernel);
+	bool uses_feature_cache = kernel && cross_sectional && !lua_kernel;
+#else
+	bool uses_feature_cache = kernel && cross_sectional;
+#endif
+
+	// the prefixes of the kernel stay subscribed to the feature cache while the strategy holds the view
+	std::shared_ptr<NexusFeatureSubscription> subscription = nullptr;
+	if (uses_feature_cache) {
+		subscription = std::make_shared<NexusFeatureSubscription>(NexusFeatureCache::instance(), kernel->feature_keys(warmup));
+	}
+
+	// the native code a strategy library was generated with is only valid for this exact kernel and query
+	uint64_t native_hash = kernel && nexus_native_supported(*kernel) ? nexus_native_hash(*kernel, query_type, N) : 0;
+	auto native_query_type = query_type;
+	auto native_N = N;
+
+	// in cross sectional mode the kernel is evaluated over the whole exchange up front and the exchange view
+	// only looks up the result. Each view owns its buffers so they keep their size between bars, a strategy
+	// evaluates its views one at a time.
+	auto cross_section_ptr = std::make_shared<NexusCrossSection>();
+
+	ExchangeViewLambda ev_chain = [=, subscription = std::move(subscription)](
+		AgisAssetLambdaChain const& lambda_opps,
+		ExchangePtr const exchange,
+		ExchangeQueryType query_type,
+		int N) -> ExchangeView
+	{
+		// bound by reference so the asset chain reads this view's values on whatever thread the engine calls it
+		auto& cross_section = *cross_section_ptr;
+		std::optional<NexusNativeKernel> native = std::nullopt;
+		if (native_hash && query_type == native_query_type && N == native_N) {
+			native = NexusNativeKernels::instance().get(native_hash);
+		}
+		bool use_cross_section = kernel && (cross_sectional || native.has_value());
+		if (native.has_value()) {
+			cross_section.evaluate(native.value(), *kernel, exchange, warmup_copy);
+		}
+		else if (use_cross_section) {
+#ifdef USE_LUAJIT
+			if (lua_kernel) cross_section.evaluate(*lua_kernel, *kernel, exchange, warmup_copy);
+			else cross_section.evaluate(*kernel, exchange, warmup_copy);
+#else
+			cross_section.evaluate(*kernel, exchange, warmup_copy);
+#endif
+			// only the selected assets reach the exchange view, so the engine sorts N instead of the universe
+			cross_section.select(query_type, N);
+		}
+
+		// function that takes in serious of operations to apply to as asset and outputs
+		// a double value that is result of said opps
+		auto asset_chain = [&](AssetPtr const& asset) -> decltype(asset_feature_lambda_chain(asset, lambda_opps)) {
+			if (use_cross_section) return cross_section.lookup(asset);
+			if (kernel) return kernel->evaluate(asset);
+			return asset_feature_lambda_chain(
+				asset,
+				lambda_opps
+			);
+		};
+
+		// function that takes an exchange an applys the asset chain to each element when 
+		// generating the exchange view
+		AGIS_TRY(
+			auto exchange_view = exchange->get_exchange_view(
+				asset_chain,
+				query_type,
+				N,
+				false,
+				warmup_copy
+			);
+			return exchange_view;
+		);
+	};
+
+	ExchangeViewLambdaStruct my_struct = {
+		N,
+		static_cast<size_t>(warmup),
+		lambda_chain,
+		ev_chain,
+		exchange,
+		query_type,
+		std::nullopt
+	};
+	return my_struct;
+}
+
+
+//============================================================================
+ExchangeViewLambdaStruct nexus_transform_view_struct(
+	ExchangeViewLambdaStruct ev_struct,
+	NexusViewTransform const& transform)
+{
+	ExchangeViewLambda inner = ev_struct.exchange_view_labmda;
+	ev_struct.exchange_view_labmda = [inner, transform](
+		AgisAssetLambdaChain const& lambda_opps,
+		ExchangePtr const exchange,
+		ExchangeQueryType query_type,
+		int N) -> ExchangeView
+	{
+		auto exchange_view = inner(lambda_opps, exchange, query_type, N);
+		transform.apply(exchange_view);
+		return exchange_view;
+	};
+	return ev_struct;
+}
+
+
+//============================================================================
+ExchangeViewLambdaStruct nexus_optimizer_view_struct(
+	ExchangeViewLambdaStruct ev_struct,
+	NexusOptimizerSettings const& settings,
+	HydraPtr const hydra)
+{
+	auto covariance_res = hydra->get_exchanges().get_covariance_matrix();
+	if (covariance_res.is_exception()) {
+		NEXUS_THROW("Portfolio optimizer requires the covariance matrix, enable it in the exchanges settings");
+	}
+	// the matrix is updated in place every cov_step bars, the optimizer notices when its block changes
+	auto covariance = covariance_res.unwrap();
+	auto optimizer = std::make_shared<NexusPortfolioOptimizer>(settings);
+	ExchangeViewLambda inner = ev_struct.exchange_view_labmda;
+	ev_struct.exchange_view_labmda = [inner, covariance, optimizer](
+		AgisAssetLambdaChain const& lambda_opps,
+		ExchangePtr const exchange,
+		ExchangeQueryType query_type,
+		int N) -> ExchangeView
+	{
+		auto exchange_view = inner(lambda_opps, exchange, query_type, N);
+		optimizer->apply(exchange_view, covariance->get_eigen_matrix());
+		return exchange_view;
+	};
+	return ev_struct;
+}
+
+
+//============================================================================
+StrategyAllocLambdaStruct nexus_strategy_alloc_struct(
+	std::string const& epsilon,
+	std::string const& target_leverage,
+	bool clear_missing,
+	std::string const& alloc_type,
+	std::string const& ev_opp_type,
+	std::optional<std::string> const& ev_opp_param,
+	std::optional<TradeExitPtr> const& trade_exit)
+{
+	std::optional<double> ev_opp_param_value = std::nullopt;
+	if (ev_opp_param.has_value()) ev_opp_param_value = stod(ev_opp_param.value());
+
+	StrategyAllocLambdaStruct _struct{
+		stod(epsilon),
+		stod(target_leverage),
+		ev_opp_param_value,
+		trade_exit,
+		clear_missing,
+		ev_opp_type,
+		agis_strat_alloc_map.at(alloc_type),
+		AllocTypeTarget::LEVERAGE
+	};
+	return _struct;
+}
+
+
 //============================================================================
 std::shared_ptr<NodeData> AssetLambdaModel::outData(PortIndex const port)
 {
@@ -412,27 +982,83 @@ std::shared_ptr<NodeData> AssetLambdaModel::outData(PortIndex const port)
 	{
 		// extract information about the asset lambda operation
 		auto op_str = this->asset_lambda_node->opperation->currentText().toStdString();
-		AgisOperation op = agis_function_map.at(op_str);
 		auto column_name = this->asset_lambda_node->column->text().toStdString();
 		auto row = this->asset_lambda_node->row->value();
+		auto filter_str = this->asset_lambda_node->filter->text().toStdString();
 		this->warmup = abs(row);
 
 		// build the asset lambda struct and push to the chain
-		AssetLambda l = AssetLambda(op, [=](const AssetPtr& asset) {
-			return asset->get_asset_feature(column_name, row);
-		});
 		AgisAssetLambdaChain new_chain = this->lambda_chain;
-		AssetLambdaScruct asset_lambda_struct{ l, op, column_name, row };
-		new_chain.push_back(asset_lambda_struct);
+		NexusLambdaProgram new_program = this->program;
+		nexus_push_asset_lambda(new_chain, new_program, op_str, column_name, row, filter_str);
 
-		// parse the filter if needed
-		auto filter_str = this->asset_lambda_node->filter->text();
-		if (!filter_str.isEmpty() && filter_str != "")
-		{
-			new_chain.push_back(AssetLambdaScruct(AssetFilterRange(filter_str.toStdString())));
-		}
+		return std::make_shared<AssetLambdaData>(std::move(new_chain), this->warmup, std::move(new_program));
+	}
+	NEXUS_THROW("unexpected out port");
+}
+
+
+//============================================================================
+std::shared_ptr<NodeData> AssetWindowModel::outData(PortIndex const port)
+{
+	if (port == 0)
+	{
+		NexusWindowSpec spec;
+		spec.type = static_cast<NexusWindowType>(this->asset_window_node->window_type->currentIndex());
+		spec.column = this->asset_window_node->column->text().toStdString();
+		spec.period = this->asset_window_node->period->value();
+		auto op_str = this->asset_window_node->opperation->currentText().toStdString();
+		auto filter_str = this->asset_window_node->filter->text().toStdString();
+
+		// the window reads period - 1 rows back, which is the warmup of the chain element
+		int row = -(spec.period - 1);
+		this->warmup = abs(row);
 
-		return std::make_shared<AssetLambdaData>(std::move(new_chain), this->warmup);
+		AgisAssetLambdaChain new_chain = this->lambda_chain;
+		NexusLambdaProgram new_program = this->program;
+		nexus_push_asset_lambda(new_chain, new_program, op_str, nexus_window_column(spec), row, filter_str);
+
+		return std::make_shared<AssetLambdaData>(std::move(new_chain), this->warmup, std::move(new_program));
+	}
+	NEXUS_THROW("unexpected out port");
+}
+
+
+//============================================================================
+std::shared_ptr<NodeData> ExchangeViewTransformModel::outData(PortIndex const port)
+{
+	if (port == 0)
+	{
+		if (!this->ev_lambda_struct.has_value()) return nullptr;
+		auto type = static_cast<NexusTransformType>(this->transform_node->transform_type->currentIndex());
+		NexusViewTransform transform(type, this->transform_node->param->value());
+		return std::make_shared<ExchangeViewData>(
+			nexus_transform_view_struct(this->ev_lambda_struct.value(), transform)
+		);
+	}
+	NEXUS_THROW("unexpected out port");
+}
+
+
+//============================================================================
+std::shared_ptr<NodeData> PortfolioOptimizerModel::outData(PortIndex const port)
+{
+	if (port == 0)
+	{
+		if (!this->ev_lambda_struct.has_value()) return nullptr;
+		try {
+			auto ev_struct = nexus_optimizer_view_struct(
+				this->ev_lambda_struct.value(),
+				this->optimizer_node->settings(),
+				ExchangeModel::hydra
+			);
+			this->optimizer_node->status->clear();
+			return std::make_shared<ExchangeViewData>(ev_struct);
+		}
+		catch (std::exception& e) {
+			this->optimizer_node->status->setText(e.what());
+			return nullptr;
+		}
 	}
 	NEXUS_THROW("unexpected out port");
 }
@@ -488,52 +1114,139 @@ std::shared_ptr<NodeData> ExchangeViewModel::outData(PortIndex const port)
 		auto N = stoi(this->exchange_view_node->N->text().toStdString());
 		auto query_string = this->exchange_view_node->query_type->currentText().toStdString();
 		auto query_type = agis_query_map.at(query_string);
-		auto warmup_copy = this->warmup;
-
-		ExchangeViewLambda ev_chain = [=](
-			AgisAssetLambdaChain const& lambda_opps,
-			ExchangePtr const exchange,
-			ExchangeQueryType query_type,
-			int N) -> ExchangeView
-		{
-			// function that takes in serious of operations to apply to as asset and outputs
-			// a double value that is result of said opps
-			auto asset_chain = [&](AssetPtr const& asset) {
-				return asset_feature_lambda_chain(
-					asset,
-					lambda_opps
-				);
-			};
-
-			// function that takes an exchange an applys the asset chain to each element when 
-			// generating the exchange view
-			AGIS_TRY(
-				auto exchange_view = exchange->get_exchange_view(
-					asset_chain,
-					query_type,
-					N,
-					false,
-					warmup_copy
-				);
-				return exchange_view;
-			);
-		};
-
-		ExchangeViewLambdaStruct my_struct = {
-			N,
-			static_cast<size_t>(this->warmup),
+		auto cross_sectional = this->exchange_view_node->cross_sectional->isChecked();
+		auto luajit = this->exchange_view_node->luajit->isChecked();
+		auto my_struct = nexus_exchange_view_struct(
 			this->lambda_chain,
-			ev_chain,
+			this->program,
 			this->exchange,
 			query_type,
-			std::nullopt
-		};
+			N,
+			this->warmup,
+			cross_sectional,
+			luajit
+		);
 		return std::make_shared<ExchangeViewData>(my_struct);
 	}
 	NEXUS_THROW("unexpected out port");
 }
 
 
+//============================================================================
+static bool nexus_views_match(decltype(ExchangeView::view) a, decltype(ExchangeView::view) b)
+{
+	// the engine orders a view by value, ties make that order differ between paths so compare by asset index
+	if (a.size() != b.size()) return false;
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (a[i].first != b[i].first) return false;
+		double x = a[i].second;
+		double y = b[i].second;
+		if (std::abs(x - y) > 1e-9 * std::max({ 1.0, std::abs(x), std::abs(y) })) return false;
+	}
+	return true;
+}
+
+
+//============================================================================
+std::optional<NexusKernelBenchmark> ExchangeViewModel::benchmark_kernel(size_t iterations) const
+{
+	if (!this->exchange || this->lambda_chain.empty() || !this->program.has_value()) return std::nullopt;
+	auto kernel = NexusLambdaKernel::compile(this->program.value(), this->exchange);
+	if (!kernel.has_value()) return std::nullopt;
+
+	auto N = this->exchange_view_node->N->value();
+	auto query_type = agis_query_map.at(this->exchange_view_node->query_type->currentText().toStdString());
+	auto const& lambda_opps = this->lambda_chain;
+	auto interpreted_chain = [&](AssetPtr const& asset) {
+		return asset_feature_lambda_chain(asset, lambda_opps);
+	};
+	auto compiled_chain = [&](AssetPtr const& asset) -> decltype(asset_feature_lambda_chain(asset, lambda_opps)) {
+		return kernel->evaluate(asset, true);
+	};
+	NexusCrossSection cross_section;
+	auto cross_sectional_chain = [&](AssetPtr const& asset) -> decltype(asset_feature_lambda_chain(asset, lambda_opps)) {
+		return cross_section.lookup(asset);
+	};
+
+	// generate the same exchange view with both paths so the timings include the engine's own overhead
+	NexusKernelBenchmark result;
+	result.iterations = iterations;
+	decltype(ExchangeView::view) interpreted_view, compiled_view, cross_sectional_view;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		interpreted_view = this->exchange->get_exchange_view(interpreted_chain, query_type, N, false, this->warmup).view;
+	}
+	auto mid = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		compiled_view = this->exchange->get_exchange_view(compiled_chain, query_type, N, false, this->warmup).view;
+	}
+	auto stop = std::chrono::high_resolution_clock::now();
+
+	// a private feature cache leaves the buffers of the live strategies alone, it is dropped before every
+	// iteration so each one pays for the full kernel
+	NexusFeatureCache feature_cache;
+	for (size_t i = 0; i < iterations; i++)
+	{
+		feature_cache.clear();
+		cross_section.evaluate(kernel.value(), this->exchange, this->warmup, &feature_cache);
+		cross_sectional_view = this->exchange->get_exchange_view(cross_sectional_chain, query_type, N, false, this->warmup).view;
+	}
+	auto cross_stop = std::chrono::high_resolution_clock::now();
+
+	// ordering the last cross section with a full sort against the partial selection
+	std::vector<double> scratch;
+	std::vector<std::pair<double, size_t>> sorted;
+	NexusSelection selection;
+	auto sort_start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		auto const& values = cross_section.get_values();
+		sorted.clear();
+		for (size_t j = 0; j < values.size(); j++)
+		{
+			if (std::isfinite(values[j])) sorted.emplace_back(values[j], j);
+		}
+		std::sort(sorted.begin(), sorted.end());
+	}
+	auto sort_stop = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		scratch = cross_section.get_values();
+		selection.select(scratch, query_type, N);
+	}
+	auto selection_stop = std::chrono::high_resolution_clock::now();
+
+	result.interpreted_ms = std::chrono::duration<double, std::milli>(mid - start).count();
+	result.compiled_ms = std::chrono::duration<double, std::milli>(stop - mid).count();
+	result.cross_sectional_ms = std::chrono::duration<double, std::milli>(cross_stop - stop).count();
+	result.sort_ms = std::chrono::duration<double, std::milli>(sort_stop - sort_start).count();
+	result.selection_ms = std::chrono::duration<double, std::milli>(selection_stop - sort_stop).count();
+	result.filters = kernel->filter_stats();
+	result.views_match = nexus_views_match(interpreted_view, compiled_view) && nexus_views_match(interpreted_view, cross_sectional_view);
+	return result;
+}
+
+
+//============================================================================
+std::optional<NexusPreviewRequest> ExchangeViewModel::preview_request() const
+{
+	if (!this->exchange || !this->exchange_view_node || this->lambda_chain.empty() || !this->program.has_value()) {
+		return std::nullopt;
+	}
+	NexusPreviewRequest request;
+	request.exchange = this->exchange;
+	request.program = this->program.value();
+	request.query_type = agis_query_map.at(this->exchange_view_node->query_type->currentText().toStdString());
+	request.N = this->exchange_view_node->N->value();
+	return request;
+}
+
+
 //============================================================================
 void AssetLambdaModel::setInData(std::shared_ptr<NodeData> data, PortIndex const port)
 {
@@ -541,17 +1254,73 @@ void AssetLambdaModel::setInData(std::shared_ptr<NodeData> data, PortIndex const
 	{
 		if (!data) { 
 			this->lambda_chain.clear(); 
+			this->program = std::vector<NexusLambdaInstruction>{};
 			Q_EMIT dataInvalidated(0);
 			return; 
 		}
 		std::shared_ptr<AssetLambdaData> assetData = std::dynamic_pointer_cast<AssetLambdaData>(data);
 		this->lambda_chain = assetData->lambda_chain;
+		this->program = assetData->program;
+		if (assetData->warmup > this->warmup) { this->warmup = assetData->warmup; }
+		Q_EMIT dataUpdated(0);
+	}
+}
+
+
+//============================================================================
+void AssetWindowModel::setInData(std::shared_ptr<NodeData> data, PortIndex const port)
+{
+	if (port == 0)
+	{
+		if (!data) {
+			this->lambda_chain.clear();
+			this->program = std::vector<NexusLambdaInstruction>{};
+			Q_EMIT dataInvalidated(0);
+			return;
+		}
+		std::shared_ptr<AssetLambdaData> assetData = std::dynamic_pointer_cast<AssetLambdaData>(data);
+		this->lambda_chain = assetData->lambda_chain;
+		this->program = assetData->program;
 		if (assetData->warmup > this->warmup) { this->warmup = assetData->warmup; }
 		Q_EMIT dataUpdated(0);
 	}
 }
 
 
+//============================================================================
+void ExchangeViewTransformModel::setInData(std::shared_ptr<NodeData> data, PortIndex const port)
+{
+	if (port == 0)
+	{
+		if (!data) {
+			this->ev_lambda_struct = std::nullopt;
+			Q_EMIT dataInvalidated(0);
+			return;
+		}
+		std::shared_ptr<ExchangeViewData> ev_ptr = std::dynamic_pointer_cast<ExchangeViewData>(data);
+		this->ev_lambda_struct = ev_ptr->exchange_view_lambda;
+		Q_EMIT dataUpdated(0);
+	}
+}
+
+
+//============================================================================
+void PortfolioOptimizerModel::setInData(std::shared_ptr<NodeData> data, PortIndex const port)
+{
+	if (port == 0)
+	{
+		if (!data) {
+			this->ev_lambda_struct = std::nullopt;
+			Q_EMIT dataInvalidated(0);
+			return;
+		}
+		std::shared_ptr<ExchangeViewData> ev_ptr = std::dynamic_pointer_cast<ExchangeViewData>(data);
+		this->ev_lambda_struct = ev_ptr->exchange_view_lambda;
+		Q_EMIT dataUpdated(0);
+	}
+}
+
+
 //============================================================================
 void ExchangeViewModel::setInData(std::shared_ptr<NodeData> data, PortIndex const port)
 {
@@ -561,6 +1330,7 @@ void ExchangeViewModel::setInData(std::shared_ptr<NodeData> data, PortIndex cons
 			if (!data) 
 			{ 
 				this->lambda_chain.clear(); 
+				this->program = std::nullopt;
 				Q_EMIT dataInvalidated(0);
 				return; 
 			}
@@ -568,44 +1338,16 @@ void ExchangeViewModel::setInData(std::shared_ptr<NodeData> data, PortIndex cons
 			// take in the asset lambda chain and convert the string columns to size_t indexes
 			// to prevent map lookups at runtime 
 			std::shared_ptr<AssetLambdaData> assetData = std::dynamic_pointer_cast<AssetLambdaData>(data);
-			this->lambda_chain.clear();
-			for(AssetLambdaScruct& lambda_struct : assetData->lambda_chain)
+			this->program = assetData->program;
+			auto resolved_chain = nexus_resolve_lambda_chain(assetData->lambda_chain, this->exchange);
+			if (!resolved_chain.has_value())
 			{
-				// if the asset lambda struct is a filter then just push it to the chain
-				if (lambda_struct.is_filter()) {
-					this->lambda_chain.emplace_back(lambda_struct);
-					continue;
-				}
-
-				// parse column name, if it is invalid return. Needs to be improved
-				auto& operation = lambda_struct.get_asset_operation_struct();
-				auto& column_name = operation.column;
-				auto column_index_res = this->exchange->get_column_index(column_name);
-				if (column_index_res.is_exception())
-				{
-					this->lambda_chain.clear();
-					Q_EMIT dataInvalidated(0);
-					return;
-				}
-				// with the new column index create a new asset lambda struct and push to the chain
-				auto column_index = column_index_res.unwrap();
-				auto row = operation.row;
-				AssetLambda lambda_op = AssetLambda(operation.asset_lambda.first, [=](const AssetPtr& asset) {
-					return asset->get_asset_feature(column_index, row);
-					});
-				AssetLambdaScruct asset_lambda_struct{ lambda_op, operation.asset_lambda.first, column_name, row};
-				this->lambda_chain.emplace_back(asset_lambda_struct);
-			}
-
-			// extract the warmup needed for the lambda chain
-			int min_row = 0;
-			for (auto& asset_lambda_struct : this->lambda_chain)
-			{
-				if (asset_lambda_struct.is_filter()) continue;
-				auto& operation = asset_lambda_struct.get_asset_operation_struct();
-				if (operation.row < min_row) { min_row = operation.row; }
+				this->lambda_chain.clear();
+				Q_EMIT dataInvalidated(0);
+				return;
 			}
-			this->warmup = abs(min_row);
+			this->lambda_chain = std::move(resolved_chain.value());
+			this->warmup = nexus_lambda_chain_warmup(this->lambda_chain);
 
 			Q_EMIT dataUpdated(0);
 			return;
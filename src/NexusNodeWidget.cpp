@@ -64,6 +64,42 @@ TradeExitNode::TradeExitNode(
 }
 
 
+//============================================================================
+ExchangeViewTransformNode::ExchangeViewTransformNode(
+    QWidget* parent_)
+    : QWidget(parent_)
+    , layout(nullptr)
+{
+    setSizePolicy(QSizePolicy::Policy::Minimum, QSizePolicy::Policy::Minimum);
+
+    this->layout = new QVBoxLayout(this);
+
+    QHBoxLayout* row_layout = new QHBoxLayout(this);
+    this->transform_type = new QComboBox();
+    for (const auto& item : nexus_transform_strings) {
+        this->transform_type->addItem(QString::fromStdString(item));
+    }
+    QLabel* label = new QLabel("Transform: ");
+    row_layout->addWidget(label);
+    row_layout->addWidget(this->transform_type);
+    this->layout->addLayout(row_layout);
+
+    // number of standard deviations to clip at, only used by WINSORIZE
+    row_layout = new QHBoxLayout(this);
+    this->param = new QDoubleSpinBox(this);
+    this->param->setMinimum(0.0);
+    this->param->setMaximum(100.0);
+    this->param->setSingleStep(0.5);
+    this->param->setValue(3.0);
+    label = new QLabel("Sigma: ");
+    row_layout->addWidget(label);
+    row_layout->addWidget(this->param);
+    this->layout->addLayout(row_layout);
+
+    this->setFixedSize(layout->sizeHint());
+}
+
+
 //============================================================================
 AssetLambdaNode::AssetLambdaNode(
     QWidget* parent_)
@@ -116,6 +152,69 @@ AssetLambdaNode::AssetLambdaNode(
 }
 
 
+//============================================================================
+AssetWindowNode::AssetWindowNode(
+    QWidget* parent_)
+    : QWidget(parent_)
+    , layout(nullptr)
+{
+    setSizePolicy(QSizePolicy::Policy::Minimum, QSizePolicy::Policy::Minimum);
+
+    this->layout = new QVBoxLayout(this);
+
+    // column the window runs over
+    QHBoxLayout* name_layout = new QHBoxLayout(this);
+    QLabel* name_label = new QLabel("Column: ");
+    this->column = new QLineEdit(this);
+    name_layout->addWidget(name_label);
+    name_layout->addWidget(this->column);
+    layout->addLayout(name_layout);
+
+    // window statistic
+    QHBoxLayout* window_layout = new QHBoxLayout(this);
+    QLabel* window_label = new QLabel("Window: ");
+    this->window_type = new QComboBox();
+    for (const auto& item : nexus_window_strings) {
+        window_type->addItem(QString::fromStdString(item));
+    }
+    window_layout->addWidget(window_label);
+    window_layout->addWidget(this->window_type);
+    layout->addLayout(window_layout);
+
+    // number of bars in the window
+    QHBoxLayout* period_layout = new QHBoxLayout(this);
+    QLabel* period_label = new QLabel("Period: ");
+    this->period = new QSpinBox(this);
+    this->period->setMinimum(1);
+    this->period->setMaximum(1e6);
+    this->period->setValue(20);
+    period_layout->addWidget(period_label);
+    period_layout->addWidget(this->period);
+    layout->addLayout(period_layout);
+
+    // operation type
+    QHBoxLayout* rowLayout = new QHBoxLayout(this);
+    this->opperation = new QComboBox();
+    for (const auto& item : agis_function_strings) {
+        opperation->addItem(QString::fromStdString(item));
+    }
+    QLabel* label = new QLabel("Operation: ");
+    rowLayout->addWidget(label);
+    rowLayout->addWidget(this->opperation);
+    layout->addLayout(rowLayout);
+
+    // optional filter 
+    QHBoxLayout* filter_layout = new QHBoxLayout(this);
+    QLabel* filter_label = new QLabel("Filter Range: ");
+    this->filter = new QLineEdit(this);
+    filter_layout->addWidget(filter_label);
+    filter_layout->addWidget(this->filter);
+    layout->addLayout(filter_layout);
+
+    this->setFixedSize(layout->sizeHint());
+}
+
+
 //============================================================================
 ExchangeViewNode::ExchangeViewNode(
     QWidget* parent_)
@@ -147,10 +246,88 @@ ExchangeViewNode::ExchangeViewNode(
     row_layout->addWidget(this->N);
     layout->addLayout(row_layout);
 
+    // evaluate the lambda chain across the whole exchange at once instead of asset by asset
+    this->cross_sectional = new QCheckBox("Cross Sectional: ");
+    this->cross_sectional->setChecked(false);
+    layout->addWidget(this->cross_sectional);
+
+    // jit the cross sectional kernel with LuaJIT instead of running the C++ kernel
+    this->luajit = new QCheckBox("LuaJIT: ");
+    this->luajit->setChecked(false);
+    layout->addWidget(this->luajit);
+
     this->setFixedSize(layout->sizeHint());
 }
 
 
+//============================================================================
+PortfolioOptimizerNode::PortfolioOptimizerNode(
+    QWidget* parent_)
+    : QWidget(parent_)
+    , layout(nullptr)
+{
+    setSizePolicy(QSizePolicy::Policy::Minimum, QSizePolicy::Policy::Minimum);
+
+    this->layout = new QVBoxLayout(this);
+
+    QHBoxLayout* row_layout = new QHBoxLayout(this);
+    this->objective = new QComboBox();
+    for (const auto& item : nexus_optimizer_strings) {
+        this->objective->addItem(QString::fromStdString(item));
+    }
+    this->objective->setCurrentText("MIN_VARIANCE");
+    QLabel* label = new QLabel("Objective: ");
+    row_layout->addWidget(label);
+    row_layout->addWidget(this->objective);
+    this->layout->addLayout(row_layout);
+
+    // only used by MEAN_VARIANCE, the view values are the expected returns
+    row_layout = new QHBoxLayout(this);
+    this->risk_aversion = new QDoubleSpinBox(this);
+    this->risk_aversion->setDecimals(3);
+    this->risk_aversion->setMinimum(0.001);
+    this->risk_aversion->setMaximum(1e6);
+    this->risk_aversion->setValue(1.0);
+    label = new QLabel("Risk Aversion: ");
+    row_layout->addWidget(label);
+    row_layout->addWidget(this->risk_aversion);
+    this->layout->addLayout(row_layout);
+
+    row_layout = new QHBoxLayout(this);
+    this->max_weight = new QDoubleSpinBox(this);
+    this->max_weight->setDecimals(3);
+    this->max_weight->setMinimum(0.001);
+    this->max_weight->setMaximum(1.0);
+    this->max_weight->setSingleStep(0.01);
+    this->max_weight->setValue(1.0);
+    label = new QLabel("Max Weight: ");
+    row_layout->addWidget(label);
+    row_layout->addWidget(this->max_weight);
+    this->layout->addLayout(row_layout);
+
+    this->long_only = new QCheckBox("Long Only: ");
+    this->long_only->setChecked(true);
+    this->layout->addWidget(this->long_only);
+
+    this->status = new QLabel(this);
+    this->layout->addWidget(this->status);
+
+    this->setFixedSize(layout->sizeHint());
+}
+
+
+//============================================================================
+NexusOptimizerSettings PortfolioOptimizerNode::settings() const
+{
+    NexusOptimizerSettings settings;
+    settings.type = static_cast<NexusOptimizerType>(this->objective->currentIndex());
+    settings.risk_aversion = this->risk_aversion->value();
+    settings.max_weight = this->max_weight->value();
+    settings.long_only = this->long_only->isChecked();
+    return settings;
+}
+
+
 //============================================================================
 void StrategyAllocationNode::update_ev_opp_param_state() {
     auto val = this->ev_opp_type->currentText().toStdString();
@@ -0,0 +1,309 @@
+#include "NexusOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+const std::vector<std::string> nexus_optimizer_strings = {
+	"MEAN_VARIANCE",
+	"MIN_VARIANCE",
+	"RISK_PARITY"
+};
+
+
+//============================================================================
+std::optional<NexusOptimizerType> nexus_optimizer_type(std::string const& name)
+{
+	auto it = std::find(nexus_optimizer_strings.begin(), nexus_optimizer_strings.end(), name);
+	if (it == nexus_optimizer_strings.end()) return std::nullopt;
+	return static_cast<NexusOptimizerType>(std::distance(nexus_optimizer_strings.begin(), it));
+}
+
+
+//============================================================================
+void NexusPortfolioOptimizer::apply(ExchangeView& view, Eigen::MatrixXd const& covariance)
+{
+	// keep the assets the covariance matrix has a full row for
+	std::vector<size_t> indices;
+	std::vector<double> values;
+	indices.reserve(view.view.size());
+	for (auto const& [index, value] : view.view)
+	{
+		auto i = static_cast<Eigen::Index>(index);
+		if (i >= covariance.rows() || i >= covariance.cols()) continue;
+		double variance = covariance(i, i);
+		if (!std::isfinite(variance) || variance <= 0.0 || !std::isfinite(value)) continue;
+		indices.push_back(index);
+		values.push_back(value);
+	}
+	std::vector<size_t> keep;
+	keep.reserve(indices.size());
+	for (size_t a = 0; a < indices.size(); a++)
+	{
+		bool finite = true;
+		auto i = static_cast<Eigen::Index>(indices[a]);
+		for (size_t b = 0; b < indices.size() && finite; b++)
+		{
+			finite = std::isfinite(covariance(i, static_cast<Eigen::Index>(indices[b])));
+		}
+		if (finite) keep.push_back(a);
+	}
+
+	auto k = static_cast<Eigen::Index>(keep.size());
+	std::vector<size_t> universe(keep.size());
+	Eigen::MatrixXd sigma(k, k);
+	Eigen::VectorXd mu(k);
+	for (Eigen::Index a = 0; a < k; a++)
+	{
+		universe[a] = indices[keep[a]];
+		mu(a) = values[keep[a]];
+	}
+	for (Eigen::Index b = 0; b < k; b++)
+	{
+		auto j = static_cast<Eigen::Index>(universe[b]);
+		for (Eigen::Index a = 0; a < k; a++) sigma(a, b) = covariance(static_cast<Eigen::Index>(universe[a]), j);
+	}
+
+	view.view.clear();
+	if (k == 0) return;
+	auto weights = this->solve(universe, sigma, mu);
+	for (Eigen::Index a = 0; a < k; a++)
+	{
+		if (weights(a) != 0.0) view.view.emplace_back(universe[a], weights(a));
+	}
+}
+
+
+//============================================================================
+Eigen::VectorXd NexusPortfolioOptimizer::solve(
+	std::vector<size_t> const& indices,
+	Eigen::MatrixXd const& sigma,
+	Eigen::VectorXd const& mu)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto k = static_cast<Eigen::Index>(indices.size());
+	if (k == 0) return Eigen::VectorXd();
+
+	// carry the previous bar's solution over by asset, new assets start from the equal weight portfolio
+	this->z.resize(k);
+	this->u.resize(k);
+	for (Eigen::Index a = 0; a < k; a++)
+	{
+		auto it = this->warm.find(indices[a]);
+		this->z(a) = it != this->warm.end() ? it->second.first : 1.0 / static_cast<double>(k);
+		this->u(a) = it != this->warm.end() ? it->second.second : 0.0;
+	}
+
+	Eigen::VectorXd weights;
+	if (this->settings.type == NexusOptimizerType::RISK_PARITY) {
+		weights = this->solve_risk_parity(sigma);
+	}
+	else {
+		// the factor only depends on the covariance of the universe, the settings are fixed for the optimizer
+		bool factor_valid = this->factorizations > 0
+			&& this->factor_indices == indices
+			&& this->factor_sigma.rows() == k
+			&& (this->factor_sigma.array() == sigma.array()).all();
+		if (!factor_valid) {
+			// start from the step size the previous bar settled on, the problem rarely changes much
+			double rho = this->rho;
+			if (this->factorizations == 0) rho = this->scale() * sigma.trace() / static_cast<double>(k);
+			if (!(rho > 0.0) || !std::isfinite(rho)) rho = 1.0;
+			this->factorize(sigma, rho);
+			this->factor_indices = indices;
+			this->factor_sigma = sigma;
+		}
+		weights = this->solve_qp(sigma, mu);
+	}
+
+	this->warm.clear();
+	for (Eigen::Index a = 0; a < k; a++)
+	{
+		this->warm[indices[a]] = { this->z(a), this->u(a) };
+	}
+	return weights;
+}
+
+
+//============================================================================
+double NexusPortfolioOptimizer::scale() const
+{
+	return this->settings.type == NexusOptimizerType::MEAN_VARIANCE ? this->settings.risk_aversion : 1.0;
+}
+
+
+//============================================================================
+void NexusPortfolioOptimizer::factorize(Eigen::MatrixXd const& sigma, double rho)
+{
+	// u is the dual scaled by 1 / rho, keep the dual itself across a change of rho
+	this->u *= this->rho / rho;
+	this->rho = rho;
+	Eigen::MatrixXd system = this->scale() * sigma;
+	system.diagonal().array() += rho;
+	this->factor.compute(system);
+	this->factorizations++;
+}
+
+
+//============================================================================
+void NexusPortfolioOptimizer::project(Eigen::VectorXd& v, double lower, double upper) const
+{
+	// euclidean projection onto {sum w = 1, lower <= w <= upper} is w = clamp(v - tau), find tau by bisection
+	auto k = v.size();
+	auto excess = [&](double tau) {
+		double sum = 0.0;
+		for (Eigen::Index a = 0; a < k; a++) sum += std::clamp(v(a) - tau, lower, upper);
+		return sum - 1.0;
+	};
+	double tau_lower = v.minCoeff() - upper;
+	double tau_upper = v.maxCoeff() - lower;
+	for (int i = 0; i < 100 && tau_upper - tau_lower > 1e-15 * (1.0 + std::abs(tau_lower)); i++)
+	{
+		double tau = 0.5 * (tau_lower + tau_upper);
+		if (excess(tau) > 0.0) tau_lower = tau;
+		else tau_upper = tau;
+	}
+
+	// the bisection fixes which weights are at a bound, solve for tau exactly over the free ones
+	double tau = 0.5 * (tau_lower + tau_upper);
+	double free_sum = 0.0, bound_sum = 0.0;
+	Eigen::Index free_count = 0;
+	for (Eigen::Index a = 0; a < k; a++)
+	{
+		double w = v(a) - tau;
+		if (w <= lower) bound_sum += lower;
+		else if (w >= upper) bound_sum += upper;
+		else {
+			free_sum += v(a);
+			free_count++;
+		}
+	}
+	if (free_count > 0) tau = (free_sum + bound_sum - 1.0) / static_cast<double>(free_count);
+	for (Eigen::Index a = 0; a < k; a++) v(a) = std::clamp(v(a) - tau, lower, upper);
+}
+
+
+//============================================================================
+Eigen::VectorXd NexusPortfolioOptimizer::solve_qp(Eigen::MatrixXd const& sigma, Eigen::VectorXd const& mu)
+{
+	// min 1/2 x'Px + q'x subject to x = z, z in the budget box. ADMM with over relaxation:
+	//   x = (P + rho I)^-1 (rho (z - u) - q)
+	//   z = project(alpha x + (1 - alpha) z + u)
+	//   u = u + alpha x + (1 - alpha) z - z
+	// rho is rebalanced every few iterations from the ratio of the residuals, costing a refactorization
+	constexpr double alpha = 1.6;
+	constexpr double primal_tolerance = 1e-8;
+	constexpr double dual_tolerance = 1e-6;
+	constexpr size_t max_iterations = 4000;
+	constexpr size_t rho_interval = 25;
+
+	auto k = sigma.rows();
+	double upper = std::max(this->settings.max_weight, 1.0 / static_cast<double>(k));
+	double lower = this->settings.long_only ? 0.0 : -upper;
+	Eigen::VectorXd q = Eigen::VectorXd::Zero(k);
+	if (this->settings.type == NexusOptimizerType::MEAN_VARIANCE) q = -mu;
+
+	this->project(this->z, lower, upper);
+	Eigen::VectorXd x(k), relaxed(k), z_prev(k);
+	this->iterations = 0;
+	while (this->iterations < max_iterations)
+	{
+		this->iterations++;
+		x = this->factor.solve(this->rho * (this->z - this->u) - q);
+		relaxed = alpha * x + (1.0 - alpha) * this->z;
+		z_prev = this->z;
+		this->z = relaxed + this->u;
+		this->project(this->z, lower, upper);
+		this->u += relaxed - this->z;
+
+		double primal = (x - this->z).lpNorm<Eigen::Infinity>();
+		double dual = this->rho * (this->z - z_prev).lpNorm<Eigen::Infinity>();
+		bool check = this->iterations % rho_interval == 0;
+		if (primal >= primal_tolerance && !check) continue;
+
+		// relative to the largest term of each residual, as in OSQP
+		constexpr double tiny = 1e-30;
+		double gradient_scale = std::max({
+			(this->scale() * (sigma * x)).lpNorm<Eigen::Infinity>(),
+			q.lpNorm<Eigen::Infinity>(),
+			this->rho * this->u.lpNorm<Eigen::Infinity>(),
+			tiny
+		});
+		double relative_primal = primal / std::max({ x.lpNorm<Eigen::Infinity>(), this->z.lpNorm<Eigen::Infinity>(), tiny });
+		double relative_dual = dual / gradient_scale;
+		if (primal < primal_tolerance && relative_dual < dual_tolerance) break;
+		if (check && relative_dual > 0.0) {
+			double ratio = std::sqrt(relative_primal / relative_dual);
+			if (ratio > 5.0 || ratio < 0.2) this->factorize(sigma, this->rho * ratio);
+		}
+	}
+	return this->z;
+}
+
+
+//============================================================================
+Eigen::VectorXd NexusPortfolioOptimizer::solve_risk_parity(Eigen::MatrixXd const& sigma)
+{
+	// min f(y) = 1/2 y'Sy - b sum log y_i has w = y / sum y as the equal risk contribution portfolio.
+	// f is strictly convex so damped Newton converges quadratically, the line search keeps y > 0.
+	// z holds the unnormalized y so the next bar starts at the right scale.
+	constexpr double tolerance = 1e-10;
+	constexpr size_t max_iterations = 100;
+
+	auto k = sigma.rows();
+	double budget = 1.0 / static_cast<double>(k);
+	Eigen::VectorXd& y = this->z;
+	if (!(y.array() > 0.0).all()) {
+		// at the optimum y'Sy = sum b = 1, start new assets on the equal weight portfolio at that scale
+		double total = sigma.sum();
+		if (!(total > 0.0)) total = sigma.trace();
+		double start = 1.0 / std::sqrt(total);
+		for (Eigen::Index a = 0; a < k; a++)
+		{
+			if (!(y(a) > 0.0)) y(a) = start;
+		}
+	}
+	auto objective = [&](Eigen::VectorXd const& v) {
+		return 0.5 * v.dot(sigma * v) - budget * v.array().log().sum();
+	};
+
+	Eigen::VectorXd gradient(k), step(k), next(k);
+	Eigen::MatrixXd hessian(k, k);
+	double value = objective(y);
+	this->iterations = 0;
+	while (this->iterations < max_iterations)
+	{
+		this->iterations++;
+		gradient = sigma * y - budget * y.cwiseInverse();
+		hessian = sigma;
+		hessian.diagonal().array() += budget / y.array().square();
+		this->factor.compute(hessian);
+		this->factorizations++;
+		step = -this->factor.solve(gradient);
+
+		// newton decrement, the gap to the optimum is about half of it
+		double decrement = -gradient.dot(step);
+		if (!(decrement > tolerance * tolerance)) break;
+
+		double t = 1.0;
+		for (Eigen::Index a = 0; a < k; a++)
+		{
+			if (step(a) < 0.0) t = std::min(t, -0.99 * y(a) / step(a));
+		}
+		for (int i = 0; i < 50; i++, t *= 0.5)
+		{
+			next = y + t * step;
+			double next_value = objective(next);
+			if (next_value <= value - 0.25 * t * decrement) {
+				value = next_value;
+				break;
+			}
+		}
+		y = next;
+		if ((t * step.array() / y.array()).abs().maxCoeff() < tolerance) break;
+	}
+	// the factor was for the newton system, the QP solvers never share it with this objective
+	this->factor_indices.clear();
+	this->u.setZero();
+	return y / y.sum();
+}
@@ -313,6 +313,8 @@ NexusSettings::NexusSettings(
     this->ui->vs_version->setText(QString::fromStdString(
         agis_build_method)
     );
+    this->ui->per_strategy_libs->setChecked(nexs_env->get_per_strategy_libs());
+    this->ui->build_jobs->setValue(static_cast<int>(nexs_env->get_build_jobs()));
 
     connect(ui->select_agis_include_path, &QPushButton::clicked, this, [this]() {
         this->select_folder("include");
@@ -336,7 +338,11 @@ void NexusSettings::select_folder(std::string dest)
     QStringList filters;
 
     if (dest == "dll") {
+#ifdef _WIN32
         filters << tr("Dynamic Link Libraries (*.dll)");
+#else
+        filters << tr("Shared Libraries (*.so)");
+#endif
     }
     else if (dest == "pyd") {
         filters << tr("Python Extension Modules (*.pyd)");
@@ -400,6 +406,20 @@ QString NexusSettings::get_vs_version() const
 }
 
 
+//============================================================================
+bool NexusSettings::get_per_strategy_libs() const
+{
+    return ui->per_strategy_libs->isChecked();
+}
+
+
+//============================================================================
+size_t NexusSettings::get_build_jobs() const
+{
+    return static_cast<size_t>(ui->build_jobs->value());
+}
+
+
 //============================================================================
 void NexusSettings::on_submit()
 {
@@ -1,8 +1,12 @@
 #include <fstream>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #include "AgisOverloads.h"
 #include "NexusAsset.h"
+#include "NexusBootstrap.h"
 #include "NexusPortfolio.h"
 #include "NexusHelpers.h"
+#include "NexusRollingStats.h"
 #include "ui_NexusPortfolio.h"
 
 #include "Portfolio.h"
@@ -64,6 +68,7 @@ NexusPortfolio::NexusPortfolio(
     // load in the NexusPortfolio to the plot 
     this->set_up_toolbar();
     this->set_up_strategies_menu();
+    this->set_up_correlation_dock();
     this->set_up_portfolio_table();
     this->nexus_plot->load_portfolio(this);
 }
@@ -125,6 +130,58 @@ void NexusPortfolio::set_up_strategies_menu()
 }
 
 
+//============================================================================
+void NexusPortfolio::set_up_correlation_dock()
+{
+    this->correlation_plot = new NexusCorrelationPlot(this);
+    this->correlation_dock = new QDockWidget("Correlation", this);
+    this->correlation_dock->setWidget(this->correlation_plot);
+    this->addDockWidget(Qt::RightDockWidgetArea, this->correlation_dock);
+    this->correlation_dock->hide();
+
+    // the toggle action shows the dock, the matrix is only computed while it is visible
+    auto a = this->correlation_dock->toggleViewAction();
+    a->setIcon(svgIcon("./images/grid_on.svg"));
+    ui->toolBar->addAction(a);
+    connect(this->correlation_dock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) this->on_correlation_update();
+    });
+}
+
+
+//============================================================================
+void NexusPortfolio::on_correlation_update()
+{
+    auto hydra = this->nexus_env->get_hydra();
+    auto portfolio = hydra->get_portfolio(this->portfolio_id);
+
+    // collect every strategy in the portfolio including the benchmark, independent of the strategies menu
+    std::vector<std::string> ids;
+    std::vector<std::vector<double>> nlv_histories;
+    for (auto const& id : portfolio->get_strategy_ids())
+    {
+        // benchmark ids are the only ones allowed to contain a space
+        if (id.find(" ") != std::string::npos) {
+            auto benchmark = portfolio->__get_benchmark_strategy();
+            if (!benchmark) continue;
+            nlv_histories.push_back(benchmark->get_nlv_history());
+        }
+        else {
+            if (!hydra->strategy_exists(id)) continue;
+            nlv_histories.push_back(hydra->get_strategy(id)->get_nlv_history());
+        }
+        ids.push_back(id);
+    }
+
+    std::vector<std::span<const double>> nlv_spans(nlv_histories.begin(), nlv_histories.end());
+    auto returns = nexus_returns_matrix(nlv_spans);
+    nlv_histories.clear();
+    auto correlation = nexus_correlation_matrix(returns);
+    auto order = nexus_cluster_order(correlation);
+    this->correlation_plot->load(ids, correlation, order);
+}
+
+
 //============================================================================
 void NexusPortfolio::set_up_portfolio_table()
 {
@@ -177,7 +234,8 @@ void populate_stats_model(
     std::vector<double> const& nlv, 
     QStandardItemModel* model, 
     size_t i,
-    std::optional<std::vector<double>> benchmark_nlv = std::nullopt
+    std::optional<std::vector<double>> benchmark_nlv = std::nullopt,
+    std::optional<BootstrapResult> bootstrap = std::nullopt
 )
 {
     // calculate total returns 
@@ -190,18 +248,28 @@ void populate_stats_model(
     item = new QStandardItem(x);
     model->setItem(1, i, item);
 
+    // append the bootstrap confidence interval to a stat if one was computed
+    auto with_interval = [&](QString const& value, BootstrapInterval const& interval, QString const& suffix) -> QString {
+        if (!bootstrap.has_value() || !bootstrap->valid || std::isnan(interval.lower)) return value;
+        return value + " [" + QString::number(interval.lower, 'f', 2) + suffix + ", "
+            + QString::number(interval.upper, 'f', 2) + suffix + "]";
+    };
+
     // calculate annualized returns
     x = QString::number(get_stats_annualized_pct_returns(nlv), 'f', 2) + "%";
+    if (bootstrap.has_value()) x = with_interval(x, bootstrap->annualized_return, "%");
     item = new QStandardItem(x);
     model->setItem(2, i, item);
 
     // calculate annualized volatility
     x = QString::number(get_stats_annualized_volatility(nlv), 'f', 2) + "%";
+    if (bootstrap.has_value()) x = with_interval(x, bootstrap->annualized_volatility, "%");
     item = new QStandardItem(x);
     model->setItem(3, i, item);
 
     // calculate annualized sharpe
     x = QString::number(get_stats_sharpe_ratio(nlv), 'f', 2);
+    if (bootstrap.has_value()) x = with_interval(x, bootstrap->sharpe, "");
     item = new QStandardItem(x);
     model->setItem(4, i, item);
 
@@ -288,37 +356,57 @@ void NexusPortfolio::on_new_hydra_run()
     auto benchmark = portfolio->__get_benchmark_strategy();
     if(benchmark) benchmark_nlv = benchmark->get_nlv_history();
 
-    size_t i = 0;
+    // collect the nlv history of every selected strategy so the bootstrap can resample them together
+    std::vector<std::vector<double>> nlv_histories;
+    std::vector<std::string> strategy_columns;
     for (const auto& id : selected_strategies)
     {
         // stats for the overall portfolio
         if (id == "AGGREGATE") {
-            auto& nlv = this->nexus_env->get_hydra()->get_portfolio(this->portfolio_id)->get_nlv_history_vec();
-            populate_stats_model(nlv, model, i, benchmark_nlv);
+            nlv_histories.push_back(this->nexus_env->get_hydra()->get_portfolio(this->portfolio_id)->get_nlv_history_vec());
         }
         // check if bench mark strategy by looking for a space in the id (only allowed for benchmark
         else if (id.find(" ") != std::string::npos) {
             auto portfolio = this->nexus_env->get_hydra()->get_portfolio(this->portfolio_id);
-            auto nlv = portfolio->__get_benchmark_strategy()->get_nlv_history();
-            populate_stats_model(nlv, model, i, benchmark_nlv);
+            nlv_histories.push_back(portfolio->__get_benchmark_strategy()->get_nlv_history());
 		}
         // stats for a specific strategy
 		else {
             // TODO listen for strategy delete event and remove from selected_strategies
             if (!this->nexus_env->get_hydra()->strategy_exists(id)) {
-                // remove from selected strategies vector 
-                selected_strategies.erase(std::remove(
-					selected_strategies.begin(),
-					selected_strategies.end(), id),
-                    					selected_strategies.end());
                 this->set_up_strategies_menu();
                 continue;
             }
-			auto nlv = this->nexus_env->get_hydra()->get_strategy(id)->get_nlv_history();
-            populate_stats_model(nlv, model, i, benchmark_nlv);
+			nlv_histories.push_back(this->nexus_env->get_hydra()->get_strategy(id)->get_nlv_history());
         }
-        i++;
+        strategy_columns.push_back(id);
+    }
+    model->setColumnCount(strategy_columns.size());
+    model->setHorizontalHeaderLabels(str_vec_to_qlist(strategy_columns));
+
+    // fill in the point estimates now, the block bootstrap over all strategies runs on a worker and adds the
+    // confidence intervals when it returns. A newer run drops the intervals of an older one.
+    for (size_t i = 0; i < nlv_histories.size(); i++)
+    {
+        populate_stats_model(nlv_histories[i], model, i, benchmark_nlv);
     }
+    auto current = ++this->bootstrap_generation;
+    auto histories = std::make_shared<std::vector<std::vector<double>>>(std::move(nlv_histories));
+    auto watcher = new QFutureWatcher<std::vector<BootstrapResult>>(this);
+    connect(watcher, &QFutureWatcher<std::vector<BootstrapResult>>::finished, this, [this, watcher, current, histories, model, benchmark_nlv]() {
+        auto bootstrap = watcher->result();
+        watcher->deleteLater();
+        if (current != this->bootstrap_generation) return;
+        for (size_t i = 0; i < histories->size(); i++)
+        {
+            populate_stats_model((*histories)[i], model, i, benchmark_nlv, bootstrap[i]);
+        }
+        this->stats_table_view->resizeColumnsToContents();
+    });
+    watcher->setFuture(QtConcurrent::run([histories]() {
+        std::vector<std::span<const double>> nlv_spans(histories->begin(), histories->end());
+        return NexusBootstrap().run(nlv_spans);
+    }));
 
     // get the absolute and pct returns for the portfolio
     auto hydra = this->nexus_env->get_hydra();
@@ -335,6 +423,9 @@ void NexusPortfolio::on_new_hydra_run()
 
     // replot the portfolio table
     this->set_up_portfolio_table();
+
+    // refresh the correlation heatmap if it is open
+    if (this->correlation_dock->isVisible()) this->on_correlation_update();
 }
 
 
@@ -344,6 +435,63 @@ NexusPortfolioPlot::NexusPortfolioPlot(QWidget* parent_)
 }
 
 
+//============================================================================
+NexusCorrelationPlot::NexusCorrelationPlot(QWidget* parent_) : QCustomPlot(parent_)
+{
+    this->color_map = new QCPColorMap(this->xAxis, this->yAxis);
+    this->color_scale = new QCPColorScale(this);
+    this->plotLayout()->addElement(0, 1, this->color_scale);
+    this->color_scale->setType(QCPAxis::atRight);
+    this->color_map->setColorScale(this->color_scale);
+    QCPColorGradient gradient(QCPColorGradient::gpPolar);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    this->color_map->setGradient(gradient);
+    this->color_map->setDataRange(QCPRange(-1.0, 1.0));
+    this->color_map->setInterpolate(false);
+    this->color_scale->axis()->setLabel("Correlation");
+
+    // keep the color scale aligned with the heatmap
+    QCPMarginGroup* margin_group = new QCPMarginGroup(this);
+    this->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, margin_group);
+    this->color_scale->setMarginGroup(QCP::msBottom | QCP::msTop, margin_group);
+
+    this->xAxis->setTickLabelRotation(90);
+    this->yAxis->setRangeReversed(true);
+    this->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+}
+
+
+//============================================================================
+void NexusCorrelationPlot::load(
+    std::vector<std::string> const& ids,
+    Eigen::MatrixXd const& correlation,
+    std::vector<size_t> const& order)
+{
+    int n = static_cast<int>(order.size());
+    auto x_ticker = QSharedPointer<QCPAxisTickerText>::create();
+    auto y_ticker = QSharedPointer<QCPAxisTickerText>::create();
+    this->color_map->data()->setSize(n, n);
+    this->color_map->data()->setRange(QCPRange(0, std::max(0, n - 1)), QCPRange(0, std::max(0, n - 1)));
+
+    // cell (x, y) holds the correlation of the x'th and y'th strategies in cluster order
+    for (int x = 0; x < n; x++)
+    {
+        QString label = QString::fromStdString(ids[order[x]]);
+        x_ticker->addTick(x, label);
+        y_ticker->addTick(x, label);
+        for (int y = 0; y < n; y++)
+        {
+            this->color_map->data()->setCell(x, y, correlation(order[x], order[y]));
+        }
+    }
+    this->xAxis->setTicker(x_ticker);
+    this->yAxis->setTicker(y_ticker);
+    this->xAxis->setRange(-0.5, n - 0.5);
+    this->yAxis->setRange(-0.5, n - 0.5);
+    this->replot();
+}
+
+
 //============================================================================
 void NexusPortfolioPlot::removeAllGraphs()
 {
@@ -385,7 +533,7 @@ void NexusPortfolioPlot::contextMenuRequest(QPoint pos)
 
         std::vector<std::string> menu_cols = { 
             "CASH", "NET BETA DOLLARS / NLV", "NET BETA DOLLARS","NET LEVERAGE",
-            "NLV","UNDERWATER", "FORWARD VOLATILIY", "REALIZED VOLATILITY"
+            "NLV","UNDERWATER", "FORWARD VOLATILIY", "REALIZED VOLATILITY", "ROLLING SHARPE"
         };
         for (auto& col : menu_cols)
 		{
@@ -462,7 +610,7 @@ std::vector<double> NexusPortfolioPlot::get_data(
         else {
             y_span = std::get<PortfolioPtr>(entity)->get_nlv_history();
         }
-        return get_stats_underwater_plot(y_span);
+        return nexus_underwater(y_span);
 
     }
     else if (name == "FORWARD VOLATILIY") {
@@ -481,8 +629,18 @@ std::vector<double> NexusPortfolioPlot::get_data(
         else {
             y_span = std::get<PortfolioPtr>(entity)->get_nlv_history();
         }
-        return rolling_volatility(y_span, 252);
+        return nexus_rolling_volatility(y_span, 252);
 	}
+    else if (name == "ROLLING SHARPE") {
+        std::vector<double> y_span;
+        if (std::holds_alternative<AgisStrategy*>(entity)) {
+            y_span = std::get<AgisStrategy*>(entity)->get_nlv_history();
+        }
+        else {
+            y_span = std::get<PortfolioPtr>(entity)->get_nlv_history();
+        }
+        return nexus_rolling_sharpe(y_span, 252);
+    }
     // Return an empty span if the name doesn't match any condition
     return std::vector<double>();
 }
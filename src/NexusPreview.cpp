@@ -0,0 +1,244 @@
+#include "NexusPreview.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <QFutureWatcher>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "Exchange.h"
+
+
+//============================================================================
+NexusPreviewResult nexus_preview_evaluate(
+	NexusPreviewRequest const& request,
+	int row,
+	std::function<bool()> const& cancelled)
+{
+	NexusPreviewResult result;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// shift every load back to the previewed bar, rolling windows end at the shifted row of their instruction
+	auto program = request.program;
+	for (auto& instruction : program) instruction.row += row;
+	auto kernel = NexusLambdaKernel::compile(program, request.exchange);
+	if (!kernel.has_value()) {
+		result.error = "chain could not be compiled for the exchange";
+		return result;
+	}
+
+	std::vector<AssetPtr> assets;
+	for (auto const& asset : request.exchange->get_assets())
+	{
+		if (!asset || !asset->__is_streaming) continue;
+		assets.push_back(asset);
+	}
+
+	// the instructions are applied one at a time so a stale preview stops after the current pass
+	std::vector<double> feature;
+	result.values.assign(assets.size(), 0.0);
+	for (size_t i = 0; i < kernel->size(); i++)
+	{
+		if (cancelled()) {
+			result.cancelled = true;
+			return result;
+		}
+		kernel->evaluate_instruction(i, assets, result.values, feature);
+	}
+
+	auto selection_values = result.values;
+	NexusSelection selection;
+	selection.select(selection_values, request.query_type, request.N);
+	result.selected.resize(assets.size());
+	result.asset_ids.reserve(assets.size());
+	for (size_t j = 0; j < assets.size(); j++)
+	{
+		result.selected[j] = !std::isnan(selection_values[j]);
+		result.asset_ids.push_back(assets[j]->get_asset_id());
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+	return result;
+}
+
+
+std::vector<NexusPreview*> NexusPreview::instances;
+int NexusPreview::suspended = 0;
+
+
+//============================================================================
+NexusPreview::NexusPreview(QWidget* parent) :
+	QWidget(parent),
+	generation(std::make_shared<std::atomic<uint64_t>>(0))
+{
+	QVBoxLayout* l = new QVBoxLayout(this);
+
+	QHBoxLayout* row_layout = new QHBoxLayout();
+	QLabel* row_label = new QLabel("Preview Row: ");
+	this->row = new QSpinBox(this);
+	this->row->setMinimum(-100000);
+	this->row->setMaximum(0);
+	this->row->setValue(0);
+	row_layout->addWidget(row_label);
+	row_layout->addWidget(this->row);
+	l->addLayout(row_layout);
+
+	this->status = new QLabel("No exchange view", this);
+	l->addWidget(this->status);
+
+	this->table = new QTableWidget(0, 3, this);
+	this->table->setHorizontalHeaderLabels({ "Asset", "Value", "Selected" });
+	this->table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+	this->table->verticalHeader()->setVisible(false);
+	this->table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	l->addWidget(this->table);
+
+	// graph edits arrive in bursts (every keystroke of a column or filter), wait for them to settle
+	this->debounce = new QTimer(this);
+	this->debounce->setSingleShot(true);
+	this->debounce->setInterval(300);
+	connect(this->debounce, &QTimer::timeout, this, &NexusPreview::evaluate);
+	connect(this->row, &QSpinBox::valueChanged, this, &NexusPreview::schedule);
+	instances.push_back(this);
+}
+
+
+//============================================================================
+NexusPreview::~NexusPreview()
+{
+	// stop any evaluation still running, the worker holds its own reference to the counter
+	this->generation->fetch_add(1);
+	std::erase(instances, this);
+}
+
+
+//============================================================================
+void NexusPreview::set_request_source(std::function<std::optional<NexusPreviewRequest>()> source)
+{
+	this->request_source = std::move(source);
+	this->schedule();
+}
+
+
+//============================================================================
+void NexusPreview::schedule()
+{
+	this->debounce->start();
+}
+
+
+//============================================================================
+void NexusPreview::evaluate()
+{
+	if (suspended > 0) {
+		this->status->setText("Waiting for the run to finish...");
+		return;
+	}
+
+	// invalidate whatever is still running before deciding if there is anything new to run
+	uint64_t current = this->generation->fetch_add(1) + 1;
+	std::optional<NexusPreviewRequest> request = std::nullopt;
+	try {
+		if (this->request_source) request = this->request_source();
+	}
+	catch (std::exception& e) {
+		this->status->setText("Preview failed: " + QString(e.what()));
+		return;
+	}
+	if (!request.has_value()) {
+		this->status->setText("No exchange view");
+		this->table->setRowCount(0);
+		return;
+	}
+
+	this->status->setText("Evaluating...");
+	auto counter = this->generation;
+	int row = this->row->value();
+	auto watcher = new QFutureWatcher<NexusPreviewResult>(this);
+	connect(watcher, &QFutureWatcher<NexusPreviewResult>::finished, this, [this, watcher, current]() {
+		auto result = watcher->result();
+		watcher->deleteLater();
+		if (result.cancelled || current != this->generation->load()) return;
+		this->display(result);
+	});
+	this->running = QtConcurrent::run([request = std::move(request.value()), row, counter, current]() {
+		auto cancelled = [&counter, current]() { return counter->load() != current; };
+		NexusPreviewResult result;
+		try {
+			result = nexus_preview_evaluate(request, row, cancelled);
+		}
+		catch (std::exception& e) {
+			result.error = e.what();
+		}
+		result.generation = current;
+		return result;
+	});
+	watcher->setFuture(this->running);
+}
+
+
+//============================================================================
+void NexusPreview::display(NexusPreviewResult const& result)
+{
+	if (!result.error.empty()) {
+		this->status->setText("Preview failed: " + QString::fromStdString(result.error));
+		this->table->setRowCount(0);
+		return;
+	}
+
+	// selected assets first, each group by value descending with nan last
+	std::vector<size_t> order(result.values.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&result](size_t i, size_t j) {
+		if (result.selected[i] != result.selected[j]) return static_cast<bool>(result.selected[i]);
+		double x = result.values[i], y = result.values[j];
+		if (std::isnan(x) || std::isnan(y)) return !std::isnan(x) && std::isnan(y);
+		return x > y;
+	});
+
+	size_t selected_count = std::count(result.selected.begin(), result.selected.end(), true);
+	this->status->setText(
+		QString::number(result.values.size()) + " assets, "
+		+ QString::number(selected_count) + " selected, "
+		+ QString::number(result.elapsed_ms, 'f', 2) + " ms"
+	);
+
+	this->table->setUpdatesEnabled(false);
+	this->table->setRowCount(static_cast<int>(order.size()));
+	for (int r = 0; r < static_cast<int>(order.size()); r++)
+	{
+		size_t j = order[r];
+		auto value = std::isnan(result.values[j]) ? QString("nan") : QString::number(result.values[j], 'g', 8);
+		this->table->setItem(r, 0, new QTableWidgetItem(QString::fromStdString(result.asset_ids[j])));
+		this->table->setItem(r, 1, new QTableWidgetItem(value));
+		this->table->setItem(r, 2, new QTableWidgetItem(result.selected[j] ? "Yes" : ""));
+	}
+	this->table->setUpdatesEnabled(true);
+}
+
+
+//============================================================================
+NexusPreviewSuspend::NexusPreviewSuspend()
+{
+	// cancelled evaluations stop after the instruction they are in, wait for that before hydra moves
+	NexusPreview::suspended++;
+	for (auto preview : NexusPreview::instances)
+	{
+		preview->generation->fetch_add(1);
+		preview->running.waitForFinished();
+	}
+}
+
+
+//============================================================================
+NexusPreviewSuspend::~NexusPreviewSuspend()
+{
+	// the run moved hydra, every preview shows the bar it was at before
+	if (--NexusPreview::suspended > 0) return;
+	for (auto preview : NexusPreview::instances) preview->schedule();
+}
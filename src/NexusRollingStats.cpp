@@ -0,0 +1,219 @@
+#include "NexusRollingStats.h"
+
+#include <stdexcept>
+
+
+//============================================================================
+RollingBuffer::RollingBuffer(size_t capacity)
+{
+	if (capacity == 0) throw std::invalid_argument("rolling window must be greater than 0");
+	this->data.resize(capacity);
+}
+
+
+//============================================================================
+std::optional<double> RollingBuffer::push(double value)
+{
+	this->sequence++;
+	if (this->count < this->data.size())
+	{
+		this->data[(this->head + this->count) % this->data.size()] = value;
+		this->count++;
+		return std::nullopt;
+	}
+	// buffer is full, overwrite the oldest value and advance the head
+	double evicted = this->data[this->head];
+	this->data[this->head] = value;
+	this->head = (this->head + 1) % this->data.size();
+	return evicted;
+}
+
+
+//============================================================================
+void RollingBuffer::clear()
+{
+	this->head = 0;
+	this->count = 0;
+	this->sequence = 0;
+}
+
+
+//============================================================================
+void RollingVariance::push(double value)
+{
+	if (std::isnan(value)) return;
+	auto evicted = this->buffer.push(value);
+	if (evicted.has_value() && this->n > 0)
+	{
+		// remove the evicted value from the running moments
+		double x = evicted.value();
+		if (this->n == 1) {
+			this->n = 0;
+			this->m = 0.0;
+			this->m2 = 0.0;
+		}
+		else {
+			double delta = x - this->m;
+			this->n--;
+			this->m -= delta / this->n;
+			this->m2 -= delta * (x - this->m);
+		}
+	}
+	double delta = value - this->m;
+	this->n++;
+	this->m += delta / this->n;
+	this->m2 += delta * (value - this->m);
+
+	// guard against small negative values from floating point cancellation
+	if (this->m2 < 0.0) this->m2 = 0.0;
+}
+
+
+//============================================================================
+void RollingVariance::clear()
+{
+	this->buffer.clear();
+	this->n = 0;
+	this->m = 0.0;
+	this->m2 = 0.0;
+}
+
+
+//============================================================================
+RollingMinMax::RollingMinMax(size_t window_) : window(window_)
+{
+	// an empty window would evict every value and leave nothing to take the front of
+	if (window_ == 0) throw std::invalid_argument("rolling window must be greater than 0");
+}
+
+
+//============================================================================
+void RollingMinMax::push(double value)
+{
+	size_t id = this->sequence++;
+
+	// drop values that can never be the min/max again
+	while (!this->min_deque.empty() && this->min_deque.back().second >= value) this->min_deque.pop_back();
+	while (!this->max_deque.empty() && this->max_deque.back().second <= value) this->max_deque.pop_back();
+	this->min_deque.emplace_back(id, value);
+	this->max_deque.emplace_back(id, value);
+
+	// drop values that have left the window
+	while (this->min_deque.front().first + this->window <= id) this->min_deque.pop_front();
+	while (this->max_deque.front().first + this->window <= id) this->max_deque.pop_front();
+}
+
+
+//============================================================================
+void RollingMinMax::clear()
+{
+	this->sequence = 0;
+	this->min_deque.clear();
+	this->max_deque.clear();
+}
+
+
+//============================================================================
+void RollingDrawdown::push(double value)
+{
+	double high;
+	if (this->window == 0) {
+		if (value > this->all_time_high) this->all_time_high = value;
+		high = this->all_time_high;
+	}
+	else {
+		this->peak.push(value);
+		high = this->peak.max();
+	}
+	this->current = high != 0.0 ? (value - high) / high : 0.0;
+	if (this->current < this->worst) this->worst = this->current;
+}
+
+
+//============================================================================
+void RollingDrawdown::clear()
+{
+	this->peak.clear();
+	this->all_time_high = -std::numeric_limits<double>::infinity();
+	this->current = NAN;
+	this->worst = 0.0;
+}
+
+
+//============================================================================
+void RollingSharpe::push(double value)
+{
+	if (!std::isnan(this->previous) && this->previous != 0.0)
+	{
+		this->returns.push((value - this->previous) / this->previous);
+	}
+	this->previous = value;
+}
+
+
+//============================================================================
+void RollingSharpe::clear()
+{
+	this->returns.clear();
+	this->previous = NAN;
+}
+
+
+//============================================================================
+double RollingSharpe::volatility() const noexcept
+{
+	if (!this->ready()) return NAN;
+	return this->returns.stddev() * std::sqrt(this->annualization);
+}
+
+
+//============================================================================
+double RollingSharpe::sharpe() const noexcept
+{
+	if (!this->ready()) return NAN;
+	double sigma = this->returns.stddev();
+	if (sigma == 0.0) return NAN;
+	return (this->returns.mean() / sigma) * std::sqrt(this->annualization);
+}
+
+
+//============================================================================
+std::vector<double> nexus_rolling_volatility(std::span<const double> values, size_t window)
+{
+	std::vector<double> out(values.size(), NAN);
+	RollingSharpe stats(window);
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		stats.push(values[i]);
+		out[i] = stats.volatility();
+	}
+	return out;
+}
+
+
+//============================================================================
+std::vector<double> nexus_rolling_sharpe(std::span<const double> values, size_t window)
+{
+	std::vector<double> out(values.size(), NAN);
+	RollingSharpe stats(window);
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		stats.push(values[i]);
+		out[i] = stats.sharpe();
+	}
+	return out;
+}
+
+
+//============================================================================
+std::vector<double> nexus_underwater(std::span<const double> values, size_t window)
+{
+	std::vector<double> out(values.size(), NAN);
+	RollingDrawdown drawdown(window);
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		drawdown.push(values[i]);
+		out[i] = drawdown.drawdown();
+	}
+	return out;
+}
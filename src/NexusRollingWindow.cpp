@@ -0,0 +1,219 @@
+#include "NexusRollingWindow.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "NexusLambdaKernel.h"
+#include "Exchange.h"
+
+
+const std::vector<std::string> nexus_window_strings = {
+	"SMA",
+	"EMA",
+	"STD",
+	"ZSCORE",
+	"MIN",
+	"MAX",
+	"RANK"
+};
+
+
+//============================================================================
+std::string nexus_window_column(NexusWindowSpec const& spec)
+{
+	return nexus_window_strings[static_cast<size_t>(spec.type)]
+		+ "(" + spec.column + "," + std::to_string(spec.period) + ")";
+}
+
+
+//============================================================================
+std::optional<NexusWindowSpec> nexus_parse_window_column(std::string const& column)
+{
+	auto open = column.find('(');
+	auto comma = column.rfind(',');
+	if (open == std::string::npos || comma == std::string::npos || comma < open || column.back() != ')') {
+		return std::nullopt;
+	}
+	auto it = std::find(nexus_window_strings.begin(), nexus_window_strings.end(), column.substr(0, open));
+	if (it == nexus_window_strings.end()) return std::nullopt;
+
+	NexusWindowSpec spec;
+	spec.type = static_cast<NexusWindowType>(std::distance(nexus_window_strings.begin(), it));
+	spec.column = column.substr(open + 1, comma - open - 1);
+	try {
+		size_t pos = 0;
+		auto period_str = column.substr(comma + 1, column.size() - comma - 2);
+		spec.period = std::stoi(period_str, &pos);
+		if (pos != period_str.size()) return std::nullopt;
+	}
+	catch (std::exception&) {
+		return std::nullopt;
+	}
+	if (spec.column.empty() || spec.period < 1) return std::nullopt;
+	return spec;
+}
+
+
+//============================================================================
+NexusRollingWindow::NexusRollingWindow(
+	NexusWindowType type_,
+	size_t column_index_,
+	int period_,
+	ExchangePtr const exchange_,
+	int row_) :
+	type(type_),
+	column_index(column_index_),
+	period(static_cast<size_t>(std::max(period_, 1))),
+	row(row_),
+	exchange(exchange_)
+{
+}
+
+
+//============================================================================
+NexusRollingWindow::State::State(NexusWindowType type, size_t period) :
+	window(period)
+{
+	switch (type)
+	{
+		case NexusWindowType::SMA:
+		case NexusWindowType::STD:
+		case NexusWindowType::ZSCORE:
+			this->moments.emplace(period);
+			break;
+		case NexusWindowType::MIN:
+		case NexusWindowType::MAX:
+			this->extremes.emplace(period);
+			break;
+		default:
+			break;
+	}
+}
+
+
+//============================================================================
+double NexusRollingWindow::newest(State const& state, size_t back) const
+{
+	return state.window[state.window.size() - 1 - back];
+}
+
+
+//============================================================================
+long long NexusRollingWindow::current_row(AssetPtr const& asset) const
+{
+	auto const& dt_index = asset->__get_dt_index(false);
+	auto it = std::upper_bound(dt_index.begin(), dt_index.end(), this->exchange->get_datetime());
+	return static_cast<long long>(std::distance(dt_index.begin(), it)) - 1;
+}
+
+
+//============================================================================
+void NexusRollingWindow::push(State& state, double x) const
+{
+	auto evicted = state.window.push(x);
+	switch (this->type)
+	{
+		case NexusWindowType::SMA:
+		case NexusWindowType::STD:
+		case NexusWindowType::ZSCORE:
+			state.moments->push(x);
+			break;
+		case NexusWindowType::EMA: {
+			// seeded at the oldest value of the window so the value doesn't depend on how long the state has
+			// been updated. Sliding the seed from the evicted value to the new oldest one keeps it O(1):
+			// ema' = (1 - alpha) * ema + alpha * x - (1 - alpha)^period * (evicted - oldest)
+			double alpha = 2.0 / (static_cast<double>(this->period) + 1.0);
+			if (state.window.pushed() == 1) {
+				state.ema = x;
+			}
+			else {
+				state.ema = alpha * x + (1.0 - alpha) * state.ema;
+				if (evicted.has_value()) {
+					state.ema -= std::pow(1.0 - alpha, static_cast<double>(this->period)) * (evicted.value() - state.window[0]);
+				}
+			}
+			break;
+		}
+		case NexusWindowType::MIN:
+		case NexusWindowType::MAX:
+			state.extremes->push(x);
+			break;
+		case NexusWindowType::RANK:
+			if (evicted.has_value()) {
+				state.sorted.erase(std::lower_bound(state.sorted.begin(), state.sorted.end(), evicted.value()));
+			}
+			state.sorted.insert(std::upper_bound(state.sorted.begin(), state.sorted.end(), x), x);
+			break;
+	}
+}
+
+
+//============================================================================
+void NexusRollingWindow::rebuild(State& state, AssetPtr const& asset) const
+{
+	state = State(this->type, this->period);
+	int first_row = this->row - static_cast<int>(this->period - 1);
+	for (int row = first_row; row <= this->row; row++)
+	{
+		double x = nexus_load_feature(asset, this->column_index, row);
+		if (std::isnan(x)) continue;
+		this->push(state, x);
+	}
+}
+
+
+//============================================================================
+double NexusRollingWindow::result(State const& state) const
+{
+	constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+	if (!state.window.full()) return nan;
+	switch (this->type)
+	{
+		case NexusWindowType::SMA: return state.moments->mean();
+		case NexusWindowType::EMA: return state.ema;
+		case NexusWindowType::STD: return state.moments->stddev();
+		case NexusWindowType::ZSCORE: {
+			double sigma = state.moments->stddev();
+			if (!(sigma > 0.0)) return nan;
+			return (this->newest(state, 0) - state.moments->mean()) / sigma;
+		}
+		case NexusWindowType::MIN: return state.extremes->min();
+		case NexusWindowType::MAX: return state.extremes->max();
+		case NexusWindowType::RANK: {
+			if (this->period < 2) return nan;
+			auto below = std::lower_bound(state.sorted.begin(), state.sorted.end(), this->newest(state, 0));
+			return static_cast<double>(std::distance(state.sorted.begin(), below)) / (static_cast<double>(this->period) - 1.0);
+		}
+	}
+	return nan;
+}
+
+
+//============================================================================
+double NexusRollingWindow::value(AssetPtr const& asset)
+{
+	if (!asset) return std::numeric_limits<double>::quiet_NaN();
+	auto index = asset->get_asset_index();
+	auto& shard = this->shards[index % shard_count];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto& state = shard.states.try_emplace(index, this->type, this->period).first->second;
+
+	// an asset that has not moved since the last update (repeated calls in a bar, or a bar it doesn't stream on)
+	// still ends its window at the same row
+	auto current_row = this->current_row(asset);
+	if (state.row >= 0 && state.row == current_row) return state.result;
+
+	double x = nexus_load_feature(asset, this->column_index, this->row);
+	if (std::isnan(x)) return x;
+
+	// only a state updated at the previous row of the asset is continuous, values are not compared as flat
+	// or stale prices repeat them
+	if (state.row >= 0 && state.row + 1 == current_row) this->push(state, x);
+	else this->rebuild(state, asset);
+
+	state.row = current_row;
+	state.result = this->result(state);
+	return state.result;
+}
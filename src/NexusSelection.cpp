@@ -0,0 +1,57 @@
+#include "NexusSelection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+//============================================================================
+void NexusSelection::select(std::vector<double>& values, ExchangeQueryType query_type, int N)
+{
+	if (query_type == ExchangeQueryType::Default || N < 0) return;
+	size_t n = static_cast<size_t>(N);
+	constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+	// gather the finite values, anything nan or inf would be dropped by the exchange view anyway
+	this->candidates.clear();
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		if (!std::isfinite(values[i])) {
+			values[i] = nan;
+			continue;
+		}
+		this->candidates.emplace_back(values[i], i);
+	}
+
+	// partition so the selected candidates sit in [keep_lo, keep_hi), everything else is masked
+	auto begin = this->candidates.begin();
+	auto end = this->candidates.end();
+	size_t m = this->candidates.size();
+	auto by_value = [](auto const& a, auto const& b) { return a.first < b.first; };
+	auto by_value_desc = [](auto const& a, auto const& b) { return a.first > b.first; };
+	switch (query_type)
+	{
+		case ExchangeQueryType::NLargest: {
+			if (m <= n) return;
+			std::nth_element(begin, begin + n, end, by_value_desc);
+			for (auto it = begin + n; it != end; ++it) values[it->second] = nan;
+			break;
+		}
+		case ExchangeQueryType::NSmallest: {
+			if (m <= n) return;
+			std::nth_element(begin, begin + n, end, by_value);
+			for (auto it = begin + n; it != end; ++it) values[it->second] = nan;
+			break;
+		}
+		case ExchangeQueryType::NExtreme: {
+			// keep n from each side, a superset of however the engine splits N between the two ends
+			if (m <= 2 * n) return;
+			std::nth_element(begin, begin + n, end, by_value);
+			std::nth_element(begin + n, end - n, end, by_value);
+			for (auto it = begin + n; it != end - n; ++it) values[it->second] = nan;
+			break;
+		}
+		default:
+			break;
+	}
+}
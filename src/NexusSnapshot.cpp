@@ -0,0 +1,284 @@
+#include "NexusSnapshot.h"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+#include "NexusCodeGen.h"
+
+static_assert(std::endian::native == std::endian::little, "snapshots are stored little endian");
+
+static constexpr char snapshot_magic[4] = { 'N', 'X', 'S', 'S' };
+static constexpr size_t snapshot_header_size = 4 + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+
+/// <summary>
+/// Tags of the encoded values
+/// </summary>
+enum class SnapshotTag : uint8_t
+{
+	NULL_VALUE,
+	FALSE_VALUE,
+	TRUE_VALUE,
+	INT64,
+	UINT64,
+	DOUBLE,
+	STRING,
+	ARRAY,
+	OBJECT
+};
+
+
+//============================================================================
+template <typename T>
+static void put(std::string& out, T value)
+{
+	char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	out.append(bytes, sizeof(T));
+}
+
+
+//============================================================================
+template <typename T>
+static void patch(std::string& out, size_t offset, T value)
+{
+	std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+
+//============================================================================
+static void encode_string(std::string& out, char const* str, size_t length)
+{
+	put(out, static_cast<uint32_t>(length));
+	out.append(str, length);
+	out.push_back('\0');
+}
+
+
+//============================================================================
+static void encode_value(std::string& out, rapidjson::Value const& value)
+{
+	switch (value.GetType())
+	{
+		case rapidjson::kNullType:
+			put(out, SnapshotTag::NULL_VALUE);
+			return;
+		case rapidjson::kFalseType:
+			put(out, SnapshotTag::FALSE_VALUE);
+			return;
+		case rapidjson::kTrueType:
+			put(out, SnapshotTag::TRUE_VALUE);
+			return;
+		case rapidjson::kStringType:
+			put(out, SnapshotTag::STRING);
+			encode_string(out, value.GetString(), value.GetStringLength());
+			return;
+		case rapidjson::kNumberType:
+			if (value.IsDouble()) {
+				put(out, SnapshotTag::DOUBLE);
+				put(out, value.GetDouble());
+			}
+			else if (value.IsInt64()) {
+				put(out, SnapshotTag::INT64);
+				put(out, value.GetInt64());
+			}
+			else {
+				put(out, SnapshotTag::UINT64);
+				put(out, value.GetUint64());
+			}
+			return;
+		case rapidjson::kArrayType: {
+			put(out, SnapshotTag::ARRAY);
+			put(out, static_cast<uint32_t>(value.Size()));
+			size_t size_offset = out.size();
+			put(out, uint64_t(0));
+			for (auto const& element : value.GetArray()) encode_value(out, element);
+			patch(out, size_offset, static_cast<uint64_t>(out.size() - size_offset - sizeof(uint64_t)));
+			return;
+		}
+		case rapidjson::kObjectType: {
+			put(out, SnapshotTag::OBJECT);
+			put(out, static_cast<uint32_t>(value.MemberCount()));
+			size_t size_offset = out.size();
+			put(out, uint64_t(0));
+			for (auto const& member : value.GetObject())
+			{
+				encode_string(out, member.name.GetString(), member.name.GetStringLength());
+				encode_value(out, member.value);
+			}
+			patch(out, size_offset, static_cast<uint64_t>(out.size() - size_offset - sizeof(uint64_t)));
+			return;
+		}
+	}
+}
+
+
+//============================================================================
+std::string NexusSnapshot::encode(rapidjson::Value const& value)
+{
+	std::string payload;
+	encode_value(payload, value);
+
+	std::string out;
+	out.reserve(snapshot_header_size + payload.size());
+	out.append(snapshot_magic, sizeof(snapshot_magic));
+	put(out, version);
+	put(out, static_cast<uint64_t>(payload.size()));
+	put(out, nexus_content_hash(payload));
+	out += payload;
+	return out;
+}
+
+
+//============================================================================
+void NexusSnapshot::write(fs::path const& path, rapidjson::Value const& value)
+{
+	auto content = encode(value);
+	auto temp_path = path;
+	temp_path += ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to write env snapshot: " + temp_path.string());
+		}
+		file.write(content.data(), static_cast<std::streamsize>(content.size()));
+		if (!file) {
+			throw std::runtime_error("Failed to write env snapshot: " + temp_path.string());
+		}
+	}
+	std::error_code ec;
+	fs::rename(temp_path, path, ec);
+	if (ec) {
+		fs::remove(temp_path, ec);
+		throw std::runtime_error("Failed to replace env snapshot: " + path.string());
+	}
+}
+
+
+/// <summary>
+/// Bounds checked cursor over the snapshot payload
+/// </summary>
+struct SnapshotReader
+{
+	char const* pos;
+	char const* end;
+	rapidjson::Document::AllocatorType& allocator;
+
+	void require(size_t n) const
+	{
+		if (static_cast<size_t>(this->end - this->pos) < n) throw std::runtime_error("Env snapshot is truncated");
+	}
+
+	template <typename T>
+	T get()
+	{
+		this->require(sizeof(T));
+		T value;
+		std::memcpy(&value, this->pos, sizeof(T));
+		this->pos += sizeof(T);
+		return value;
+	}
+
+	rapidjson::Value string()
+	{
+		auto length = this->get<uint32_t>();
+		this->require(size_t(length) + 1);
+		// the string stays in the snapshot buffer, the document only references it
+		rapidjson::Value value(rapidjson::StringRef(this->pos, length));
+		this->pos += size_t(length) + 1;
+		return value;
+	}
+
+	char const* container_end()
+	{
+		auto size = this->get<uint64_t>();
+		this->require(size);
+		return this->pos + size;
+	}
+
+	rapidjson::Value value()
+	{
+		switch (this->get<SnapshotTag>())
+		{
+			case SnapshotTag::NULL_VALUE: return rapidjson::Value();
+			case SnapshotTag::FALSE_VALUE: return rapidjson::Value(false);
+			case SnapshotTag::TRUE_VALUE: return rapidjson::Value(true);
+			case SnapshotTag::INT64: return rapidjson::Value(this->get<int64_t>());
+			case SnapshotTag::UINT64: return rapidjson::Value(this->get<uint64_t>());
+			case SnapshotTag::DOUBLE: return rapidjson::Value(this->get<double>());
+			case SnapshotTag::STRING: return this->string();
+			case SnapshotTag::ARRAY: {
+				auto count = this->get<uint32_t>();
+				auto container = this->container_end();
+				rapidjson::Value array(rapidjson::kArrayType);
+				array.Reserve(count, this->allocator);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					auto element = this->value();
+					array.PushBack(element, this->allocator);
+				}
+				if (this->pos != container) throw std::runtime_error("Env snapshot array size mismatch");
+				return array;
+			}
+			case SnapshotTag::OBJECT: {
+				auto count = this->get<uint32_t>();
+				auto container = this->container_end();
+				rapidjson::Value object(rapidjson::kObjectType);
+				object.MemberReserve(count, this->allocator);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					auto name = this->string();
+					auto member = this->value();
+					object.AddMember(name, member, this->allocator);
+				}
+				if (this->pos != container) throw std::runtime_error("Env snapshot object size mismatch");
+				return object;
+			}
+		}
+		throw std::runtime_error("Invalid value in env snapshot");
+	}
+};
+
+
+//============================================================================
+std::unique_ptr<NexusSnapshot> NexusSnapshot::read(fs::path const& path)
+{
+	std::unique_ptr<NexusSnapshot> snapshot(new NexusSnapshot());
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to open env snapshot: " + path.string());
+		}
+		snapshot->buffer.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(snapshot->buffer.data(), static_cast<std::streamsize>(snapshot->buffer.size()));
+		if (!file) {
+			throw std::runtime_error("Failed to read env snapshot: " + path.string());
+		}
+	}
+
+	auto const& buffer = snapshot->buffer;
+	if (buffer.size() < snapshot_header_size || std::memcmp(buffer.data(), snapshot_magic, sizeof(snapshot_magic)) != 0) {
+		throw std::runtime_error("Not an env snapshot: " + path.string());
+	}
+	uint32_t file_version;
+	uint64_t payload_size, payload_hash;
+	std::memcpy(&file_version, buffer.data() + 4, sizeof(uint32_t));
+	std::memcpy(&payload_size, buffer.data() + 8, sizeof(uint64_t));
+	std::memcpy(&payload_hash, buffer.data() + 16, sizeof(uint64_t));
+	if (file_version != version) {
+		throw std::runtime_error("Unsupported env snapshot version " + std::to_string(file_version) + ": " + path.string());
+	}
+	std::string_view payload(buffer.data() + snapshot_header_size, buffer.size() - snapshot_header_size);
+	if (payload.size() != payload_size || nexus_content_hash(payload) != payload_hash) {
+		throw std::runtime_error("Env snapshot is corrupt: " + path.string());
+	}
+
+	SnapshotReader reader{ payload.data(), payload.data() + payload.size(), snapshot->doc.GetAllocator() };
+	auto root = reader.value();
+	static_cast<rapidjson::Value&>(snapshot->doc).Swap(root);
+	return snapshot;
+}
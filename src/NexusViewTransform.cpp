@@ -0,0 +1,107 @@
+#include "NexusViewTransform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+
+const std::vector<std::string> nexus_transform_strings = {
+	"RANK",
+	"ZSCORE",
+	"DEMEAN",
+	"WINSORIZE"
+};
+
+
+//============================================================================
+std::optional<NexusTransformType> nexus_transform_type(std::string const& name)
+{
+	auto it = std::find(nexus_transform_strings.begin(), nexus_transform_strings.end(), name);
+	if (it == nexus_transform_strings.end()) return std::nullopt;
+	return static_cast<NexusTransformType>(std::distance(nexus_transform_strings.begin(), it));
+}
+
+
+//============================================================================
+static void moments(std::vector<double> const& values, double& mean, double& stddev)
+{
+	// two passes, the squares are summed around the mean. sumsq - sum * mean cancels catastrophically on price
+	// level features where the spread is tiny next to the level. Four independent accumulators per pass so the
+	// reduction isn't serialized on a single add.
+	size_t n = values.size();
+	double const* x = values.data();
+	auto reduce = [n, x](auto term) {
+		double acc[4] = { 0.0, 0.0, 0.0, 0.0 };
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			for (size_t k = 0; k < 4; k++) acc[k] += term(x[i + k]);
+		}
+		for (; i < n; i++) acc[0] += term(x[i]);
+		return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+	};
+	mean = reduce([](double v) { return v; }) / static_cast<double>(n);
+	double m = mean;
+	double var = n > 1 ? reduce([m](double v) { return (v - m) * (v - m); }) / static_cast<double>(n - 1) : 0.0;
+	stddev = std::sqrt(var);
+}
+
+
+//============================================================================
+void NexusViewTransform::apply(ExchangeView& view) const
+{
+	static thread_local std::vector<double> values;
+	static thread_local std::vector<uint32_t> order;
+
+	size_t n = view.view.size();
+	if (n == 0) return;
+	values.resize(n);
+	for (size_t i = 0; i < n; i++) values[i] = view.view[i].second;
+
+	switch (this->type)
+	{
+		case NexusTransformType::RANK: {
+			if (n == 1) {
+				view.view[0].second = 0.5;
+				return;
+			}
+			order.resize(n);
+			std::iota(order.begin(), order.end(), 0u);
+			std::sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+
+			// walk runs of equal values so ties share their average rank
+			double scale = 1.0 / static_cast<double>(n - 1);
+			size_t i = 0;
+			while (i < n)
+			{
+				size_t j = i + 1;
+				while (j < n && values[order[j]] == values[order[i]]) j++;
+				double rank = 0.5 * static_cast<double>(i + j - 1) * scale;
+				for (size_t k = i; k < j; k++) view.view[order[k]].second = rank;
+				i = j;
+			}
+			return;
+		}
+		case NexusTransformType::ZSCORE: {
+			double mean, stddev;
+			moments(values, mean, stddev);
+			double inv = stddev > 0.0 ? 1.0 / stddev : 0.0;
+			for (size_t i = 0; i < n; i++) view.view[i].second = (values[i] - mean) * inv;
+			return;
+		}
+		case NexusTransformType::DEMEAN: {
+			double mean, stddev;
+			moments(values, mean, stddev);
+			for (size_t i = 0; i < n; i++) view.view[i].second = values[i] - mean;
+			return;
+		}
+		case NexusTransformType::WINSORIZE: {
+			double mean, stddev;
+			moments(values, mean, stddev);
+			double lower = mean - this->param * stddev;
+			double upper = mean + this->param * stddev;
+			for (size_t i = 0; i < n; i++) view.view[i].second = std::clamp(values[i], lower, upper);
+			return;
+		}
+	}
+}
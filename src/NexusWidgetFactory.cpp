@@ -1,6 +1,7 @@
 
 #include "NexusWidgetFactory.h"
 #include "MainWindow.h"
+#include "NexusBuildOutput.h"
 
 
 //============================================================================
@@ -195,4 +196,37 @@ ads::CDockWidget* NexusWidgetFactory::create_file_system_tree_widget(MainWindow*
         &MainWindow::onFileDoubleClicked
     );
     return DockWidget;
-}
\ No newline at end of file
+}
+
+
+//============================================================================
+ads::CDockWidget* NexusWidgetFactory::create_build_output_widget(MainWindow* window)
+{
+    NexusBuildOutput* w = new NexusBuildOutput();
+    w->set_source_strategy([window](fs::path const& file) {
+        return window->nexus_env.source_strategy(file);
+    });
+    window->build_output = w;
+
+    // editors opened from a diagnostic are docked next to the last editor
+    w->setProperty("Floating", false);
+    w->setProperty("Tabbed", true);
+
+    QObject::connect(
+        w,
+        &NexusBuildOutput::build_finished,
+        window,
+        &MainWindow::on_build_finished
+    );
+    QObject::connect(
+        w,
+        &NexusBuildOutput::diagnostic_activated,
+        window,
+        &MainWindow::on_build_diagnostic_activated
+    );
+
+    ads::CDockWidget* DockWidget = new ads::CDockWidget(QString("Build Output"));
+    DockWidget->setWidget(w);
+    DockWidget->setIcon(svgIcon("./images/edit.svg"));
+    return DockWidget;
+}
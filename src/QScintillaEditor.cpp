@@ -324,6 +324,17 @@ void QScintillaEditor::set_current_strategy(const QString& fileName)
     this->strategy = std::nullopt;
 }
 
+void QScintillaEditor::goto_line(int line)
+{
+    // lines from compiler diagnostics are 1 based, scintilla lines are 0 based
+    if (line < 1) return;
+    textEdit->setCursorPosition(line - 1, 0);
+    textEdit->ensureLineVisible(line - 1);
+    textEdit->setFocus();
+}
+
+
+//============================================================================
 void QScintillaEditor::loadFile(const QString& fileName)
 {
     QFile file(fileName);